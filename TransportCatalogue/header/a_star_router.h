@@ -0,0 +1,176 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Поиск пути A*: Дейкстра, направляемая нижней оценкой веса до цели.
+// Оценка должна быть согласованной: bound(u, to) <= weight(u, v) + bound(v, to) для каждого ребра,
+// тогда осевшие вершины не переоткрываются и путь оптимален
+template <typename Weight>
+class AStarRouter : public RouteEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+    using LowerBound = std::function<Weight(VertexId vertex, VertexId to)>;
+
+    AStarRouter(const Graph& graph, LowerBound lower_bound);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    struct QueueItem {
+        Weight key;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return key > other.key;
+        }
+    };
+
+    void StartSearch(VertexId from, VertexId to) const {
+        if (++stamp_ == 0) {
+            std::fill(reached_stamps_.begin(), reached_stamps_.end(), 0);
+            std::fill(settled_stamps_.begin(), settled_stamps_.end(), 0);
+            stamp_ = 1;
+        }
+        // Оценки считаются лениво и живут, пока цель не сменится
+        if (to != bound_target_) {
+            bound_target_ = to;
+            if (++bound_stamp_ == 0) {
+                std::fill(bound_stamps_.begin(), bound_stamps_.end(), 0);
+                bound_stamp_ = 1;
+            }
+        }
+        queue_.clear();
+        Reach(from, ZERO_WEIGHT, NO_EDGE);
+    }
+
+    Weight GetBound(VertexId vertex) const {
+        if (bound_stamps_[vertex] != bound_stamp_) {
+            bound_stamps_[vertex] = bound_stamp_;
+            bounds_[vertex] = lower_bound_(vertex, bound_target_);
+        }
+        return bounds_[vertex];
+    }
+
+    bool IsReached(VertexId vertex) const {
+        return reached_stamps_[vertex] == stamp_;
+    }
+
+    bool IsSettled(VertexId vertex) const {
+        return settled_stamps_[vertex] == stamp_;
+    }
+
+    void Reach(VertexId vertex, Weight weight, EdgeId prev_edge) const {
+        reached_stamps_[vertex] = stamp_;
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+        queue_.push_back({weight + GetBound(vertex), vertex});
+        std::push_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+    }
+
+    bool SettleNext(VertexId& vertex) const {
+        while (!queue_.empty()) {
+            std::pop_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+            const QueueItem item = queue_.back();
+            queue_.pop_back();
+            if (IsSettled(item.vertex) || item.key > weights_[item.vertex] + bounds_[item.vertex]) {
+                continue;
+            }
+            settled_stamps_[item.vertex] = stamp_;
+            vertex = item.vertex;
+            return true;
+        }
+        return false;
+    }
+
+    void RelaxOutgoingEdges(VertexId vertex) const {
+        const Weight vertex_weight = weights_[vertex];
+        graph_.ForEachOutgoing(vertex, [this, vertex_weight](EdgeId edge_id, VertexId to, Weight weight) {
+            if (IsSettled(to)) {
+                return;
+            }
+            const Weight candidate_weight = vertex_weight + weight;
+            if (!IsReached(to) || candidate_weight < weights_[to]) {
+                Reach(to, candidate_weight, edge_id);
+            }
+        });
+    }
+
+    RouteInfo ExtractRoute(VertexId to) const {
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges_[to]; edge_id != NO_EDGE;
+             edge_id = prev_edges_[graph_.GetEdge(edge_id).from])
+        {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        return RouteInfo{weights_[to], std::move(edges)};
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    const Graph& graph_;
+    LowerBound lower_bound_;
+
+    mutable std::vector<Weight> weights_;
+    mutable std::vector<EdgeId> prev_edges_;
+    mutable std::vector<uint32_t> reached_stamps_;
+    mutable std::vector<uint32_t> settled_stamps_;
+    mutable std::vector<QueueItem> queue_;
+    mutable uint32_t stamp_ = 0;
+
+    mutable std::vector<Weight> bounds_;
+    mutable std::vector<uint32_t> bound_stamps_;
+    mutable VertexId bound_target_ = std::numeric_limits<VertexId>::max();
+    mutable uint32_t bound_stamp_ = 0;
+};
+
+template <typename Weight>
+AStarRouter<Weight>::AStarRouter(const Graph& graph, LowerBound lower_bound)
+    : graph_(graph)
+    , lower_bound_(std::move(lower_bound))
+    , weights_(graph.GetVertexCount())
+    , prev_edges_(graph.GetVertexCount(), NO_EDGE)
+    , reached_stamps_(graph.GetVertexCount(), 0)
+    , settled_stamps_(graph.GetVertexCount(), 0)
+    , bounds_(graph.GetVertexCount())
+    , bound_stamps_(graph.GetVertexCount(), 0)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(VertexId from,
+                                                                                       VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    StartSearch(from, to);
+    VertexId vertex = from;
+    while (SettleNext(vertex)) {
+        if (vertex == to) {
+            return ExtractRoute(to);
+        }
+        RelaxOutgoingEdges(vertex);
+    }
+    return std::nullopt;
+}
+
+}  // namespace graph
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "domain.h"
+#include "flat_hash_map.h"
+#include "ranges.h"
+
+namespace transport_catalogue {
+	namespace store {
+		using namespace domain;
+		class TransportCatalogue;
+
+		// Автобус снимка: маршрут и длины перегонов — отрезки общих массивов снимка
+		struct BusView {
+			std::string_view name;
+			ranges::Range<const uint32_t*> bus_route;	// id остановок
+			ranges::Range<const double*> lenghts;	// как Bus::lenghts
+			ranges::Range<const double*> back_lenghts;	// как Bus::back_lenghts
+			bool is_roundtrip = false;
+			uint32_t id = 0;
+		};
+
+		// Неизменяемый снимок каталога (TransportCatalogue::Freeze): одна таблица строк, плоские массивы
+		// остановок, автобусов, маршрутов и автобусов по остановкам. После построения ничего не меняется,
+		// поэтому читать его можно из любого числа потоков без блокировок. id совпадают с id каталога.
+		// Совершенные хэши имён общие с каталогом, свои таблицы только для имён, которых в них нет
+		class CatalogueSnapshot {
+		public:
+			explicit CatalogueSnapshot(const TransportCatalogue& catalogue);
+
+			// Представления ссылаются на собственные массивы, поэтому снимок не копируется и не перемещается
+			CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+			CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+			const BusView* FindBus(std::string_view name_bus) const;
+
+			const Stop* FindStop(std::string_view name_stop) const;
+
+			const Stop* GetStop(size_t id) const;
+
+			const BusView* GetBus(size_t id) const;
+
+			// Все остановки и автобусы в порядке id
+			const std::vector<Stop>& GetStops() const;
+
+			const std::vector<BusView>& GetBuses() const;
+
+			std::optional<BusRouteInfo> GetInfoRoute(std::string_view name_bus) const;
+
+			// Имена автобусов через остановку по алфавиту; nullopt, если остановки нет
+			std::optional<ranges::Range<const std::string_view*>> GetInfoStop(std::string_view stop) const;
+
+			// Имена автобусов через остановку по алфавиту
+			ranges::Range<const std::string_view*> GetStopBusNames(uint32_t stop_id) const;
+
+			// id автобусов, проходящих через остановку, по возрастанию
+			ranges::Range<const uint32_t*> GetStopBuses(uint32_t stop_id) const;
+
+		private:
+			std::optional<uint32_t> FindStopId(std::string_view name_stop) const;
+
+			std::optional<uint32_t> FindBusId(std::string_view name_bus) const;
+
+			std::string names_;
+			std::vector<Stop> stops_;
+			std::vector<BusView> buses_;
+			std::vector<BusRouteInfo> route_infos_;	// по id автобуса
+			std::vector<uint32_t> route_stops_;	// маршруты всех автобусов подряд
+			std::vector<double> route_lenghts_;	// для каждого автобуса lenghts, затем back_lenghts
+			std::vector<uint32_t> stop_bus_offsets_;	// автобусы остановки s — [offsets[s], offsets[s + 1])
+			std::vector<uint32_t> stop_buses_;
+			std::vector<std::string_view> stop_bus_names_;
+			std::shared_ptr<const detail::PerfectHashIndex> stop_index_;	// может быть nullptr
+			std::shared_ptr<const detail::PerfectHashIndex> bus_index_;
+			detail::FlatHashMap<std::string_view, uint32_t> unindexed_stop_ids_;
+			detail::FlatHashMap<std::string_view, uint32_t> unindexed_bus_ids_;
+		};
+	}
+}
@@ -0,0 +1,652 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Иерархия сжатий (Contraction Hierarchies): вершины сжимаются по возрастанию
+// приоритета с добавлением укороток, запрос — двунаправленный поиск вверх по рангам.
+// Укоротки при восстановлении пути раскрываются в исходные EdgeId графа.
+template <typename Weight>
+class ContractionHierarchy : public RouteEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    explicit ContractionHierarchy(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    using DistanceTable = typename RouteEngine<Weight>::DistanceTable;
+
+    // Many-to-many с корзинами: обратный подъём из каждой цели раскладывает веса по корзинам
+    // осевших вершин, прямой подъём из каждого источника собирает минимум по корзинам
+    DistanceTable BuildDistanceTable(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const override;
+
+    size_t GetShortcutCount() const {
+        return edges_.size() - original_edge_count_;
+    }
+
+private:
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    static constexpr Weight ZERO_WEIGHT{};
+
+    // Ребро иерархии: исходное ребро (second == NO_EDGE, first — его EdgeId)
+    // либо укоротка из двух рёбер иерархии first и second
+    struct HierarchyEdge {
+        VertexId from;
+        VertexId to;
+        Weight weight;
+        EdgeId first;
+        EdgeId second;
+    };
+
+    struct UpwardEdge {
+        VertexId to;
+        Weight weight;
+        EdgeId id;
+    };
+
+    struct QueueItem {
+        Weight weight;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return weight > other.weight;
+        }
+    };
+
+    // Рабочее состояние одного направления поиска
+    struct SearchSide {
+        std::vector<Weight> weights;
+        std::vector<EdgeId> prev_edges;
+        std::vector<uint32_t> reached_stamps;
+        std::vector<uint32_t> settled_stamps;
+        std::vector<QueueItem> queue;
+    };
+
+    class Contractor;
+
+    void BuildUpwardGraph();
+
+    void StartSide(SearchSide& side, VertexId from) const;
+
+    void NextStamp() const {
+        if (++stamp_ == 0) {
+            for (SearchSide* side : {&forward_side_, &backward_side_}) {
+                std::fill(side->reached_stamps.begin(), side->reached_stamps.end(), 0);
+                std::fill(side->settled_stamps.begin(), side->settled_stamps.end(), 0);
+            }
+            stamp_ = 1;
+        }
+    }
+
+    // Полный поиск по рёбрам вверх из from, on_settle(vertex, weight) для каждой осевшей вершины
+    template <typename OnSettle>
+    void SearchUpward(SearchSide& side, VertexId from, const std::vector<size_t>& offsets,
+                      const std::vector<UpwardEdge>& upward_edges, OnSettle on_settle) const;
+
+    bool IsReached(const SearchSide& side, VertexId vertex) const {
+        return side.reached_stamps[vertex] == stamp_;
+    }
+
+    void StepSide(SearchSide& side, const SearchSide& other_side, const std::vector<size_t>& offsets,
+                  const std::vector<UpwardEdge>& upward_edges, Weight& best_weight, VertexId& meeting_vertex) const;
+
+    void UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const;
+
+    const Graph& graph_;
+    size_t original_edge_count_ = 0;
+    std::vector<HierarchyEdge> edges_;
+    std::vector<size_t> ranks_;
+
+    std::vector<size_t> forward_offsets_;
+    std::vector<UpwardEdge> forward_edges_;
+    std::vector<size_t> backward_offsets_;
+    std::vector<UpwardEdge> backward_edges_;
+
+    mutable SearchSide forward_side_;
+    mutable SearchSide backward_side_;
+    mutable uint32_t stamp_ = 0;
+};
+
+// Предобработка: ленивое обновление приоритетов (разность рёбер + число сжатых соседей)
+// и ограниченный поиск свидетелей
+template <typename Weight>
+class ContractionHierarchy<Weight>::Contractor {
+public:
+    Contractor(const Graph& graph, std::vector<HierarchyEdge>& edges, std::vector<size_t>& ranks)
+        : graph_(graph)
+        , edges_(edges)
+        , ranks_(ranks)
+        , out_edges_(graph.GetVertexCount())
+        , in_edges_(graph.GetVertexCount())
+        , contracted_(graph.GetVertexCount(), false)
+        , deleted_neighbors_(graph.GetVertexCount(), 0)
+        , witness_weights_(graph.GetVertexCount())
+        , witness_stamps_(graph.GetVertexCount(), 0)
+        , target_weights_(graph.GetVertexCount())
+        , target_stamps_(graph.GetVertexCount(), 0)
+    {
+    }
+
+    void Run() {
+        AddOriginalEdges();
+
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<std::pair<int, VertexId>> queue;
+        queue.reserve(vertex_count);
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            queue.push_back({ComputePriority(vertex), vertex});
+        }
+        std::make_heap(queue.begin(), queue.end(), std::greater<>{});
+
+        size_t rank = 0;
+        while (!queue.empty()) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<>{});
+            const VertexId vertex = queue.back().second;
+            queue.pop_back();
+
+            const int priority = ComputePriority(vertex);
+            if (!queue.empty() && priority > queue.front().first) {
+                queue.push_back({priority, vertex});
+                std::push_heap(queue.begin(), queue.end(), std::greater<>{});
+                continue;
+            }
+            Contract(vertex);
+            ranks_[vertex] = rank++;
+        }
+    }
+
+private:
+    static constexpr size_t WITNESS_SETTLE_LIMIT = 50;
+
+    // Ребро оставшегося графа: vertex — второй конец, id — ребро иерархии
+    struct AdjacentEdge {
+        VertexId vertex;
+        Weight weight;
+        EdgeId id;
+    };
+
+    void AddOriginalEdges() {
+        // Петли бесполезны для кратчайших путей, из параллельных рёбер остаётся самое лёгкое
+        const size_t vertex_count = graph_.GetVertexCount();
+        std::vector<EdgeId> best_edges(vertex_count, NO_EDGE);
+        std::vector<VertexId> targets;
+        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+            targets.clear();
+            graph_.ForEachOutgoing(vertex, [&](EdgeId edge_id, VertexId to, Weight weight) {
+                if (weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                if (to == vertex) {
+                    return;
+                }
+                EdgeId& best_edge = best_edges[to];
+                if (best_edge == NO_EDGE) {
+                    targets.push_back(to);
+                    best_edge = edge_id;
+                }
+                else if (weight < graph_.GetEdge(best_edge).weight) {
+                    best_edge = edge_id;
+                }
+            });
+            for (const VertexId target : targets) {
+                const EdgeId edge_id = best_edges[target];
+                AddEdge({vertex, target, graph_.GetEdge(edge_id).weight, edge_id, NO_EDGE});
+                best_edges[target] = NO_EDGE;
+            }
+        }
+    }
+
+    void AddEdge(const HierarchyEdge& edge) {
+        edges_.push_back(edge);
+        const EdgeId id = edges_.size() - 1;
+        out_edges_[edge.from].push_back({edge.to, edge.weight, id});
+        in_edges_[edge.to].push_back({edge.from, edge.weight, id});
+    }
+
+    // Укоротка заменяет более тяжёлое ребро u->x в оставшемся графе
+    void AddShortcut(const HierarchyEdge& shortcut) {
+        auto& out_edges = out_edges_[shortcut.from];
+        const auto it_out = std::find_if(out_edges.begin(), out_edges.end(), [&shortcut](const AdjacentEdge& edge) {
+            return edge.vertex == shortcut.to;
+        });
+        if (it_out == out_edges.end()) {
+            AddEdge(shortcut);
+            return;
+        }
+        if (!(shortcut.weight < it_out->weight)) {
+            return;
+        }
+        auto& in_edges = in_edges_[shortcut.to];
+        const auto it_in = std::find_if(in_edges.begin(), in_edges.end(), [id = it_out->id](const AdjacentEdge& edge) {
+            return edge.id == id;
+        });
+        edges_.push_back(shortcut);
+        const EdgeId id = edges_.size() - 1;
+        *it_out = {shortcut.to, shortcut.weight, id};
+        *it_in = {shortcut.from, shortcut.weight, id};
+    }
+
+    void RemoveContractedEdges(VertexId vertex) {
+        const auto is_contracted = [this](const AdjacentEdge& edge) {
+            return contracted_[edge.vertex];
+        };
+        auto& out_edges = out_edges_[vertex];
+        out_edges.erase(std::remove_if(out_edges.begin(), out_edges.end(), is_contracted), out_edges.end());
+        auto& in_edges = in_edges_[vertex];
+        in_edges.erase(std::remove_if(in_edges.begin(), in_edges.end(), is_contracted), in_edges.end());
+    }
+
+    // Ограниченный Дейкстра от source в несжатом графе без вершины excluded.
+    // Останавливается, когда для всех целей найден путь не длиннее пути через excluded
+    void RunWitnessSearch(VertexId source, VertexId excluded, Weight max_weight, size_t unresolved_count) {
+        if (++witness_stamp_ == 0) {
+            std::fill(witness_stamps_.begin(), witness_stamps_.end(), 0);
+            witness_stamp_ = 1;
+        }
+        witness_queue_.clear();
+        witness_stamps_[source] = witness_stamp_;
+        witness_weights_[source] = ZERO_WEIGHT;
+        witness_queue_.push_back({ZERO_WEIGHT, source});
+
+        size_t settled = 0;
+        while (!witness_queue_.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            std::pop_heap(witness_queue_.begin(), witness_queue_.end(), std::greater<QueueItem>{});
+            const QueueItem item = witness_queue_.back();
+            witness_queue_.pop_back();
+            if (item.weight > witness_weights_[item.vertex]) {
+                continue;
+            }
+            if (item.weight > max_weight) {
+                break;
+            }
+            ++settled;
+            for (const AdjacentEdge& edge : out_edges_[item.vertex]) {
+                if (edge.vertex == excluded || contracted_[edge.vertex]) {
+                    continue;
+                }
+                const Weight candidate_weight = item.weight + edge.weight;
+                if (witness_stamps_[edge.vertex] == witness_stamp_ && !(candidate_weight < witness_weights_[edge.vertex])) {
+                    continue;
+                }
+                witness_stamps_[edge.vertex] = witness_stamp_;
+                witness_weights_[edge.vertex] = candidate_weight;
+                witness_queue_.push_back({candidate_weight, edge.vertex});
+                std::push_heap(witness_queue_.begin(), witness_queue_.end(), std::greater<QueueItem>{});
+
+                if (target_stamps_[edge.vertex] == target_stamp_ && !(target_weights_[edge.vertex] < candidate_weight)) {
+                    target_stamps_[edge.vertex] = 0;
+                    if (--unresolved_count == 0) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    bool HasWitness(VertexId target, Weight via_weight) const {
+        return witness_stamps_[target] == witness_stamp_ && !(via_weight < witness_weights_[target]);
+    }
+
+    // Обходит укоротки, необходимые при сжатии vertex; callback(in_edge, out_edge)
+    template <typename Callback>
+    void ForEachShortcut(VertexId vertex, Callback callback) {
+        for (const AdjacentEdge& in_edge : in_edges_[vertex]) {
+            if (++target_stamp_ == 0) {
+                std::fill(target_stamps_.begin(), target_stamps_.end(), 0);
+                target_stamp_ = 1;
+            }
+            // Для каждой цели запоминается самый короткий путь через vertex
+            Weight max_weight = ZERO_WEIGHT;
+            size_t target_count = 0;
+            for (const AdjacentEdge& out_edge : out_edges_[vertex]) {
+                if (out_edge.vertex == in_edge.vertex) {
+                    continue;
+                }
+                const Weight via_weight = in_edge.weight + out_edge.weight;
+                max_weight = std::max(max_weight, via_weight);
+                if (target_stamps_[out_edge.vertex] != target_stamp_) {
+                    target_stamps_[out_edge.vertex] = target_stamp_;
+                    target_weights_[out_edge.vertex] = via_weight;
+                    ++target_count;
+                }
+                else {
+                    target_weights_[out_edge.vertex] = std::min(target_weights_[out_edge.vertex], via_weight);
+                }
+            }
+            if (target_count == 0) {
+                continue;
+            }
+            RunWitnessSearch(in_edge.vertex, vertex, max_weight, target_count);
+            for (const AdjacentEdge& out_edge : out_edges_[vertex]) {
+                if (out_edge.vertex != in_edge.vertex
+                    && !HasWitness(out_edge.vertex, in_edge.weight + out_edge.weight)) {
+                    callback(in_edge, out_edge);
+                }
+            }
+        }
+    }
+
+    int ComputePriority(VertexId vertex) {
+        RemoveContractedEdges(vertex);
+        int shortcut_count = 0;
+        ForEachShortcut(vertex, [&shortcut_count](const AdjacentEdge&, const AdjacentEdge&) {
+            ++shortcut_count;
+        });
+        const int removed_count = static_cast<int>(in_edges_[vertex].size() + out_edges_[vertex].size());
+        return shortcut_count - removed_count + deleted_neighbors_[vertex];
+    }
+
+    void Contract(VertexId vertex) {
+        RemoveContractedEdges(vertex);
+        std::vector<HierarchyEdge> shortcuts;
+        ForEachShortcut(vertex, [&shortcuts](const AdjacentEdge& in_edge, const AdjacentEdge& out_edge) {
+            shortcuts.push_back({in_edge.vertex, out_edge.vertex, in_edge.weight + out_edge.weight, in_edge.id, out_edge.id});
+        });
+        contracted_[vertex] = true;
+        for (const HierarchyEdge& shortcut : shortcuts) {
+            AddShortcut(shortcut);
+        }
+        // Рёбра в сжатую вершину сразу убираются у соседей, чтобы не просматривать их при поиске свидетелей
+        for (const AdjacentEdge& edge : in_edges_[vertex]) {
+            ++deleted_neighbors_[edge.vertex];
+            RemoveContractedEdges(edge.vertex);
+        }
+        for (const AdjacentEdge& edge : out_edges_[vertex]) {
+            ++deleted_neighbors_[edge.vertex];
+            RemoveContractedEdges(edge.vertex);
+        }
+    }
+
+    const Graph& graph_;
+    std::vector<HierarchyEdge>& edges_;
+    std::vector<size_t>& ranks_;
+
+    std::vector<std::vector<AdjacentEdge>> out_edges_;
+    std::vector<std::vector<AdjacentEdge>> in_edges_;
+    std::vector<bool> contracted_;
+    std::vector<int> deleted_neighbors_;
+
+    std::vector<Weight> witness_weights_;
+    std::vector<uint32_t> witness_stamps_;
+    std::vector<QueueItem> witness_queue_;
+    uint32_t witness_stamp_ = 0;
+
+    std::vector<Weight> target_weights_;
+    std::vector<uint32_t> target_stamps_;
+    uint32_t target_stamp_ = 0;
+};
+
+template <typename Weight>
+ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+    : graph_(graph)
+    , ranks_(graph.GetVertexCount(), 0)
+{
+    Contractor contractor(graph, edges_, ranks_);
+    contractor.Run();
+    original_edge_count_ = static_cast<size_t>(std::count_if(edges_.begin(), edges_.end(), [](const HierarchyEdge& edge) {
+        return edge.second == NO_EDGE;
+    }));
+    BuildUpwardGraph();
+
+    for (SearchSide* side : {&forward_side_, &backward_side_}) {
+        side->weights.resize(graph.GetVertexCount());
+        side->prev_edges.resize(graph.GetVertexCount(), NO_EDGE);
+        side->reached_stamps.resize(graph.GetVertexCount(), 0);
+        side->settled_stamps.resize(graph.GetVertexCount(), 0);
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::BuildUpwardGraph() {
+    // Прямой поиск идёт по рёбрам u->x с rank(u) < rank(x),
+    // обратный — по рёбрам u->x с rank(u) > rank(x), хранящимся у x
+    const size_t vertex_count = graph_.GetVertexCount();
+    forward_offsets_.assign(vertex_count + 1, 0);
+    backward_offsets_.assign(vertex_count + 1, 0);
+    for (const HierarchyEdge& edge : edges_) {
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            ++forward_offsets_[edge.from + 1];
+        }
+        else {
+            ++backward_offsets_[edge.to + 1];
+        }
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        forward_offsets_[vertex + 1] += forward_offsets_[vertex];
+        backward_offsets_[vertex + 1] += backward_offsets_[vertex];
+    }
+    forward_edges_.resize(forward_offsets_.back());
+    backward_edges_.resize(backward_offsets_.back());
+
+    std::vector<size_t> forward_fill(forward_offsets_.begin(), forward_offsets_.end() - 1);
+    std::vector<size_t> backward_fill(backward_offsets_.begin(), backward_offsets_.end() - 1);
+    for (EdgeId id = 0; id < edges_.size(); ++id) {
+        const HierarchyEdge& edge = edges_[id];
+        if (ranks_[edge.from] < ranks_[edge.to]) {
+            forward_edges_[forward_fill[edge.from]++] = {edge.to, edge.weight, id};
+        }
+        else {
+            backward_edges_[backward_fill[edge.to]++] = {edge.from, edge.weight, id};
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::StartSide(SearchSide& side, VertexId from) const {
+    side.queue.clear();
+    side.reached_stamps[from] = stamp_;
+    side.weights[from] = ZERO_WEIGHT;
+    side.prev_edges[from] = NO_EDGE;
+    side.queue.push_back({ZERO_WEIGHT, from});
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::StepSide(SearchSide& side, const SearchSide& other_side,
+                                            const std::vector<size_t>& offsets,
+                                            const std::vector<UpwardEdge>& upward_edges,
+                                            Weight& best_weight, VertexId& meeting_vertex) const {
+    std::pop_heap(side.queue.begin(), side.queue.end(), std::greater<QueueItem>{});
+    const QueueItem item = side.queue.back();
+    side.queue.pop_back();
+    if (side.settled_stamps[item.vertex] == stamp_ || item.weight > side.weights[item.vertex]) {
+        return;
+    }
+    side.settled_stamps[item.vertex] = stamp_;
+
+    if (IsReached(other_side, item.vertex)) {
+        const Weight candidate_weight = item.weight + other_side.weights[item.vertex];
+        if (meeting_vertex == graph_.GetVertexCount() || candidate_weight < best_weight) {
+            best_weight = candidate_weight;
+            meeting_vertex = item.vertex;
+        }
+    }
+
+    for (size_t i = offsets[item.vertex]; i < offsets[item.vertex + 1]; ++i) {
+        const UpwardEdge& edge = upward_edges[i];
+        const Weight candidate_weight = item.weight + edge.weight;
+        if (!IsReached(side, edge.to) || candidate_weight < side.weights[edge.to]) {
+            side.reached_stamps[edge.to] = stamp_;
+            side.weights[edge.to] = candidate_weight;
+            side.prev_edges[edge.to] = edge.id;
+            side.queue.push_back({candidate_weight, edge.to});
+            std::push_heap(side.queue.begin(), side.queue.end(), std::greater<QueueItem>{});
+        }
+    }
+}
+
+template <typename Weight>
+void ContractionHierarchy<Weight>::UnpackEdge(EdgeId edge_id, std::vector<EdgeId>& edges) const {
+    std::vector<EdgeId> stack = {edge_id};
+    while (!stack.empty()) {
+        const HierarchyEdge& edge = edges_[stack.back()];
+        stack.pop_back();
+        if (edge.second == NO_EDGE) {
+            edges.push_back(edge.first);
+            continue;
+        }
+        stack.push_back(edge.second);
+        stack.push_back(edge.first);
+    }
+}
+
+template <typename Weight>
+std::optional<typename ContractionHierarchy<Weight>::RouteInfo>
+ContractionHierarchy<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count || to >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{ZERO_WEIGHT, {}};
+    }
+    NextStamp();
+    StartSide(forward_side_, from);
+    StartSide(backward_side_, to);
+
+    Weight best_weight = ZERO_WEIGHT;
+    VertexId meeting_vertex = vertex_count;
+    const auto is_active = [&](const SearchSide& side) {
+        return !side.queue.empty()
+            && (meeting_vertex == vertex_count || side.queue.front().weight < best_weight);
+    };
+    while (true) {
+        const bool forward_active = is_active(forward_side_);
+        const bool backward_active = is_active(backward_side_);
+        if (!forward_active && !backward_active) {
+            break;
+        }
+        if (forward_active
+            && (!backward_active || !(backward_side_.queue.front().weight < forward_side_.queue.front().weight))) {
+            StepSide(forward_side_, backward_side_, forward_offsets_, forward_edges_, best_weight, meeting_vertex);
+        }
+        else {
+            StepSide(backward_side_, forward_side_, backward_offsets_, backward_edges_, best_weight, meeting_vertex);
+        }
+    }
+    if (meeting_vertex == vertex_count) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> hierarchy_edges;
+    for (VertexId vertex = meeting_vertex; forward_side_.prev_edges[vertex] != NO_EDGE;
+         vertex = edges_[forward_side_.prev_edges[vertex]].from)
+    {
+        hierarchy_edges.push_back(forward_side_.prev_edges[vertex]);
+    }
+    std::reverse(hierarchy_edges.begin(), hierarchy_edges.end());
+    for (VertexId vertex = meeting_vertex; backward_side_.prev_edges[vertex] != NO_EDGE;
+         vertex = edges_[backward_side_.prev_edges[vertex]].to)
+    {
+        hierarchy_edges.push_back(backward_side_.prev_edges[vertex]);
+    }
+
+    std::vector<EdgeId> edges;
+    for (const EdgeId edge_id : hierarchy_edges) {
+        UnpackEdge(edge_id, edges);
+    }
+    Weight weight = ZERO_WEIGHT;
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+template <typename Weight>
+template <typename OnSettle>
+void ContractionHierarchy<Weight>::SearchUpward(SearchSide& side, VertexId from, const std::vector<size_t>& offsets,
+                                                const std::vector<UpwardEdge>& upward_edges, OnSettle on_settle) const {
+    NextStamp();
+    StartSide(side, from);
+    while (!side.queue.empty()) {
+        std::pop_heap(side.queue.begin(), side.queue.end(), std::greater<QueueItem>{});
+        const QueueItem item = side.queue.back();
+        side.queue.pop_back();
+        if (side.settled_stamps[item.vertex] == stamp_ || item.weight > side.weights[item.vertex]) {
+            continue;
+        }
+        side.settled_stamps[item.vertex] = stamp_;
+        on_settle(item.vertex, item.weight);
+        for (size_t i = offsets[item.vertex]; i < offsets[item.vertex + 1]; ++i) {
+            const UpwardEdge& edge = upward_edges[i];
+            const Weight candidate_weight = item.weight + edge.weight;
+            if (side.reached_stamps[edge.to] != stamp_ || candidate_weight < side.weights[edge.to]) {
+                side.reached_stamps[edge.to] = stamp_;
+                side.weights[edge.to] = candidate_weight;
+                side.queue.push_back({candidate_weight, edge.to});
+                std::push_heap(side.queue.begin(), side.queue.end(), std::greater<QueueItem>{});
+            }
+        }
+    }
+}
+
+template <typename Weight>
+typename ContractionHierarchy<Weight>::DistanceTable
+ContractionHierarchy<Weight>::BuildDistanceTable(const std::vector<VertexId>& sources,
+                                                 const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    for (const std::vector<VertexId>* vertices : {&sources, &targets}) {
+        for (const VertexId vertex : *vertices) {
+            if (vertex >= vertex_count) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+        }
+    }
+
+    struct BucketEntry {
+        VertexId vertex;
+        size_t target_index;
+        Weight weight;
+    };
+    std::vector<BucketEntry> entries;
+    for (size_t target_index = 0; target_index < targets.size(); ++target_index) {
+        SearchUpward(backward_side_, targets[target_index], backward_offsets_, backward_edges_,
+                     [&entries, target_index](VertexId vertex, Weight weight) {
+                         entries.push_back({vertex, target_index, weight});
+                     });
+    }
+    // Корзины раскладываются по вершинам подряд, как рёбра в CSR
+    std::vector<size_t> bucket_offsets(vertex_count + 1, 0);
+    for (const BucketEntry& entry : entries) {
+        ++bucket_offsets[entry.vertex + 1];
+    }
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        bucket_offsets[vertex + 1] += bucket_offsets[vertex];
+    }
+    std::vector<std::pair<size_t, Weight>> buckets(entries.size());
+    std::vector<size_t> positions(bucket_offsets.begin(), bucket_offsets.end() - 1);
+    for (const BucketEntry& entry : entries) {
+        buckets[positions[entry.vertex]++] = {entry.target_index, entry.weight};
+    }
+
+    DistanceTable table(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+    for (size_t source_index = 0; source_index < sources.size(); ++source_index) {
+        std::vector<std::optional<Weight>>& row = table[source_index];
+        SearchUpward(forward_side_, sources[source_index], forward_offsets_, forward_edges_,
+                     [&](VertexId vertex, Weight weight) {
+                         for (size_t i = bucket_offsets[vertex]; i < bucket_offsets[vertex + 1]; ++i) {
+                             const auto& [target_index, target_weight] = buckets[i];
+                             const Weight total_weight = weight + target_weight;
+                             if (!row[target_index] || total_weight < *row[target_index]) {
+                                 row[target_index] = total_weight;
+                             }
+                         }
+                     });
+    }
+    return table;
+}
+
+}  // namespace graph
@@ -0,0 +1,491 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Дерево кратчайших путей из корня: вес и последнее ребро пути до каждой вершины.
+// У корня и недостижимых вершин prev_edges == NO_EDGE
+template <typename Weight>
+struct ShortestPathTree {
+    static constexpr uint32_t NO_EDGE = std::numeric_limits<uint32_t>::max();
+
+    VertexId root = 0;
+    std::vector<Weight> weights;
+    std::vector<uint32_t> prev_edges;
+
+    bool IsReached(VertexId vertex) const {
+        return vertex == root || prev_edges[vertex] != NO_EDGE;
+    }
+
+    size_t GetMemorySize() const {
+        return sizeof(*this) + weights.capacity() * sizeof(Weight) + prev_edges.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Поиск пути из одной вершины по запросу (Дейкстра) без предрасчёта всех пар.
+// Рабочие буферы выделяются один раз и переиспользуются между запросами.
+template <typename Weight>
+class DijkstraRouter : public RouteEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    explicit DijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Один поиск на все цели, останавливается, когда все они осели
+    std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const override;
+
+    // Предрасчёта нет: граф читается при каждом поиске, перестраивать нужно только буферы под новые вершины
+    bool ApplyUpdates(const std::vector<EdgeUpdate<Weight>>& updates) override {
+        (void)updates;
+        return weights_.size() == graph_.GetVertexCount();
+    }
+
+    // Полный поиск из from без ранней остановки
+    ShortestPathTree<Weight> BuildTree(VertexId from) const;
+
+    // Восстановление пути по готовому дереву, без поиска
+    std::optional<RouteInfo> BuildRoute(const ShortestPathTree<Weight>& tree, VertexId to) const;
+
+    // Вершины с весом пути из from не больше max_weight, в порядке оседания (по возрастанию веса).
+    // Поиск обрывается на первой вершине дальше max_weight
+    std::vector<std::pair<VertexId, Weight>> BuildReachable(VertexId from, Weight max_weight) const;
+
+private:
+    struct QueueItem {
+        Weight weight;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return weight > other.weight;
+        }
+    };
+
+    void StartSearch(VertexId from) const {
+        if (++stamp_ == 0) {
+            std::fill(reached_stamps_.begin(), reached_stamps_.end(), 0);
+            std::fill(settled_stamps_.begin(), settled_stamps_.end(), 0);
+            std::fill(target_stamps_.begin(), target_stamps_.end(), 0);
+            stamp_ = 1;
+        }
+        queue_.clear();
+        Reach(from, ZERO_WEIGHT, NO_EDGE);
+    }
+
+    bool IsReached(VertexId vertex) const {
+        return reached_stamps_[vertex] == stamp_;
+    }
+
+    bool IsSettled(VertexId vertex) const {
+        return settled_stamps_[vertex] == stamp_;
+    }
+
+    void Reach(VertexId vertex, Weight weight, EdgeId prev_edge) const {
+        reached_stamps_[vertex] = stamp_;
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+        queue_.push_back({weight, vertex});
+        std::push_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+    }
+
+    // Извлекает из кучи ближайшую неосевшую вершину, либо возвращает false
+    bool SettleNext(VertexId& vertex) const {
+        while (!queue_.empty()) {
+            std::pop_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+            const QueueItem item = queue_.back();
+            queue_.pop_back();
+            if (IsSettled(item.vertex) || item.weight > weights_[item.vertex]) {
+                continue;
+            }
+            settled_stamps_[item.vertex] = stamp_;
+            vertex = item.vertex;
+            return true;
+        }
+        return false;
+    }
+
+    void RelaxOutgoingEdges(VertexId vertex) const {
+        const Weight vertex_weight = weights_[vertex];
+        graph_.ForEachOutgoing(vertex, [this, vertex_weight](EdgeId edge_id, VertexId to, Weight weight) {
+            if (IsSettled(to)) {
+                return;
+            }
+            const Weight candidate_weight = vertex_weight + weight;
+            if (!IsReached(to) || candidate_weight < weights_[to]) {
+                Reach(to, candidate_weight, edge_id);
+            }
+        });
+    }
+
+    RouteInfo ExtractRoute(VertexId to) const {
+        std::vector<EdgeId> edges;
+        for (EdgeId edge_id = prev_edges_[to]; edge_id != NO_EDGE;
+             edge_id = prev_edges_[graph_.GetEdge(edge_id).from])
+        {
+            edges.push_back(edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        return RouteInfo{weights_[to], std::move(edges)};
+    }
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    const Graph& graph_;
+
+    mutable std::vector<Weight> weights_;
+    mutable std::vector<EdgeId> prev_edges_;
+    mutable std::vector<uint32_t> reached_stamps_;
+    mutable std::vector<uint32_t> settled_stamps_;
+    mutable std::vector<uint32_t> target_stamps_;
+    mutable std::vector<QueueItem> queue_;
+    mutable uint32_t stamp_ = 0;
+};
+
+template <typename Weight>
+DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph)
+    : graph_(graph)
+    , weights_(graph.GetVertexCount())
+    , prev_edges_(graph.GetVertexCount(), NO_EDGE)
+    , reached_stamps_(graph.GetVertexCount(), 0)
+    , settled_stamps_(graph.GetVertexCount(), 0)
+    , target_stamps_(graph.GetVertexCount(), 0)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+ShortestPathTree<Weight> DijkstraRouter<Weight>::BuildTree(VertexId from) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (graph_.GetEdgeCount() >= ShortestPathTree<Weight>::NO_EDGE) {
+        throw std::length_error("Too many edges for a shortest path tree");
+    }
+    StartSearch(from);
+    VertexId vertex = from;
+    while (SettleNext(vertex)) {
+        RelaxOutgoingEdges(vertex);
+    }
+
+    ShortestPathTree<Weight> tree;
+    tree.root = from;
+    tree.weights.assign(vertex_count, ZERO_WEIGHT);
+    tree.prev_edges.assign(vertex_count, ShortestPathTree<Weight>::NO_EDGE);
+    for (vertex = 0; vertex < vertex_count; ++vertex) {
+        if (IsSettled(vertex)) {
+            tree.weights[vertex] = weights_[vertex];
+            if (prev_edges_[vertex] != NO_EDGE) {
+                tree.prev_edges[vertex] = static_cast<uint32_t>(prev_edges_[vertex]);
+            }
+        }
+    }
+    return tree;
+}
+
+template <typename Weight>
+std::vector<std::pair<VertexId, Weight>> DijkstraRouter<Weight>::BuildReachable(VertexId from, Weight max_weight) const {
+    if (from >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    std::vector<std::pair<VertexId, Weight>> reachable;
+    StartSearch(from);
+    VertexId vertex = from;
+    while (SettleNext(vertex) && !(max_weight < weights_[vertex])) {
+        reachable.emplace_back(vertex, weights_[vertex]);
+        RelaxOutgoingEdges(vertex);
+    }
+    return reachable;
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+DijkstraRouter<Weight>::BuildRoute(const ShortestPathTree<Weight>& tree, VertexId to) const {
+    if (to >= tree.weights.size()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (!tree.IsReached(to)) {
+        return std::nullopt;
+    }
+    std::vector<EdgeId> edges;
+    for (uint32_t edge_id = tree.prev_edges[to]; edge_id != ShortestPathTree<Weight>::NO_EDGE;
+         edge_id = tree.prev_edges[graph_.GetEdge(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return RouteInfo{tree.weights[to], std::move(edges)};
+}
+
+template <typename Weight>
+std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                             VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    StartSearch(from);
+    VertexId vertex = from;
+    while (SettleNext(vertex)) {
+        if (vertex == to) {
+            return ExtractRoute(to);
+        }
+        RelaxOutgoingEdges(vertex);
+    }
+    return std::nullopt;
+}
+
+template <typename Weight>
+std::vector<std::optional<typename DijkstraRouter<Weight>::RouteInfo>>
+DijkstraRouter<Weight>::BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    if (from >= vertex_count) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    StartSearch(from);
+    size_t remaining_targets = 0;
+    for (const VertexId to : targets) {
+        if (to >= vertex_count) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        if (target_stamps_[to] != stamp_) {
+            target_stamps_[to] = stamp_;
+            ++remaining_targets;
+        }
+    }
+    VertexId vertex = from;
+    while (remaining_targets > 0 && SettleNext(vertex)) {
+        if (target_stamps_[vertex] == stamp_ && --remaining_targets == 0) {
+            break;
+        }
+        RelaxOutgoingEdges(vertex);
+    }
+
+    std::vector<std::optional<RouteInfo>> routes;
+    routes.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (IsSettled(to)) {
+            routes.push_back(ExtractRoute(to));
+        }
+        else {
+            routes.push_back(std::nullopt);
+        }
+    }
+    return routes;
+}
+
+// Двунаправленный Дейкстра: прямой поиск из from по исходящим рёбрам и обратный из to по входящим.
+// Каждый шаг делает сторона с меньшим минимумом кучи; поиск заканчивается, когда сумма минимумов
+// двух куч не меньше лучшего найденного пути через вершину, достигнутую обеими сторонами
+template <typename Weight>
+class BidirectionalDijkstraRouter : public RouteEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    explicit BidirectionalDijkstraRouter(const Graph& graph);
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+private:
+    struct QueueItem {
+        Weight weight;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return weight > other.weight;
+        }
+    };
+
+    // Рабочее состояние одного направления поиска
+    struct SearchSide {
+        std::vector<Weight> weights;
+        std::vector<EdgeId> prev_edges;
+        std::vector<uint32_t> reached_stamps;
+        std::vector<uint32_t> settled_stamps;
+        std::vector<QueueItem> queue;
+    };
+
+    bool IsReached(const SearchSide& side, VertexId vertex) const {
+        return side.reached_stamps[vertex] == stamp_;
+    }
+
+    bool IsSettled(const SearchSide& side, VertexId vertex) const {
+        return side.settled_stamps[vertex] == stamp_;
+    }
+
+    void InitSide(SearchSide& side) const;
+
+    void Reach(SearchSide& side, VertexId vertex, Weight weight, EdgeId prev_edge) const {
+        side.reached_stamps[vertex] = stamp_;
+        side.weights[vertex] = weight;
+        side.prev_edges[vertex] = prev_edge;
+        side.queue.push_back({weight, vertex});
+        std::push_heap(side.queue.begin(), side.queue.end(), std::greater<QueueItem>{});
+    }
+
+    // Снимает устаревшие записи с вершины кучи; false, если куча опустела
+    bool SkipStale(SearchSide& side) const {
+        while (!side.queue.empty()) {
+            const QueueItem& top = side.queue.front();
+            if (!IsSettled(side, top.vertex) && !(top.weight > side.weights[top.vertex])) {
+                return true;
+            }
+            std::pop_heap(side.queue.begin(), side.queue.end(), std::greater<QueueItem>{});
+            side.queue.pop_back();
+        }
+        return false;
+    }
+
+    // Оседает вершина с вершины кучи, рёбра перебирает for_each_edge(vertex, callback)
+    template <typename ForEachEdge>
+    void StepSide(SearchSide& side, const SearchSide& other_side, ForEachEdge for_each_edge,
+                  std::optional<Weight>& best_weight, VertexId& meeting_vertex) const;
+
+    const Graph& graph_;
+    ReverseAdjacency<Weight> reverse_;
+
+    mutable SearchSide forward_side_;
+    mutable SearchSide backward_side_;
+    mutable uint32_t stamp_ = 0;
+};
+
+template <typename Weight>
+BidirectionalDijkstraRouter<Weight>::BidirectionalDijkstraRouter(const Graph& graph)
+    : graph_(graph)
+    , reverse_(graph)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < Weight{}) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+    InitSide(forward_side_);
+    InitSide(backward_side_);
+}
+
+template <typename Weight>
+void BidirectionalDijkstraRouter<Weight>::InitSide(SearchSide& side) const {
+    const size_t vertex_count = graph_.GetVertexCount();
+    side.weights.resize(vertex_count);
+    side.prev_edges.assign(vertex_count, std::numeric_limits<EdgeId>::max());
+    side.reached_stamps.assign(vertex_count, 0);
+    side.settled_stamps.assign(vertex_count, 0);
+}
+
+template <typename Weight>
+template <typename ForEachEdge>
+void BidirectionalDijkstraRouter<Weight>::StepSide(SearchSide& side, const SearchSide& other_side,
+                                                   ForEachEdge for_each_edge, std::optional<Weight>& best_weight,
+                                                   VertexId& meeting_vertex) const {
+    std::pop_heap(side.queue.begin(), side.queue.end(), std::greater<QueueItem>{});
+    const VertexId vertex = side.queue.back().vertex;
+    side.queue.pop_back();
+    side.settled_stamps[vertex] = stamp_;
+
+    const Weight vertex_weight = side.weights[vertex];
+    for_each_edge(vertex, [&](EdgeId edge_id, VertexId next, Weight weight) {
+        if (IsSettled(side, next)) {
+            return;
+        }
+        const Weight candidate_weight = vertex_weight + weight;
+        if (IsReached(side, next) && !(candidate_weight < side.weights[next])) {
+            return;
+        }
+        Reach(side, next, candidate_weight, edge_id);
+        if (IsReached(other_side, next)) {
+            const Weight total_weight = candidate_weight + other_side.weights[next];
+            if (!best_weight || total_weight < *best_weight) {
+                best_weight = total_weight;
+                meeting_vertex = next;
+            }
+        }
+    });
+}
+
+template <typename Weight>
+std::optional<typename BidirectionalDijkstraRouter<Weight>::RouteInfo>
+BidirectionalDijkstraRouter<Weight>::BuildRoute(VertexId from, VertexId to) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    if (from == to) {
+        return RouteInfo{Weight{}, {}};
+    }
+    if (++stamp_ == 0) {
+        InitSide(forward_side_);
+        InitSide(backward_side_);
+        stamp_ = 1;
+    }
+    constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    forward_side_.queue.clear();
+    backward_side_.queue.clear();
+    Reach(forward_side_, from, Weight{}, NO_EDGE);
+    Reach(backward_side_, to, Weight{}, NO_EDGE);
+
+    std::optional<Weight> best_weight;
+    VertexId meeting_vertex = from;
+    const auto for_each_outgoing = [this](VertexId vertex, auto callback) {
+        graph_.ForEachOutgoing(vertex, callback);
+    };
+    const auto for_each_incoming = [this](VertexId vertex, auto callback) {
+        reverse_.ForEachIncoming(vertex, callback);
+    };
+    // Пустая куча значит, что все вершины этой стороны осели и лучший путь уже найден
+    while (SkipStale(forward_side_) && SkipStale(backward_side_)) {
+        const Weight forward_top = forward_side_.queue.front().weight;
+        const Weight backward_top = backward_side_.queue.front().weight;
+        if (best_weight && !(forward_top + backward_top < *best_weight)) {
+            break;
+        }
+        if (!(backward_top < forward_top)) {
+            StepSide(forward_side_, backward_side_, for_each_outgoing, best_weight, meeting_vertex);
+        }
+        else {
+            StepSide(backward_side_, forward_side_, for_each_incoming, best_weight, meeting_vertex);
+        }
+    }
+    if (!best_weight) {
+        return std::nullopt;
+    }
+
+    std::vector<EdgeId> edges;
+    for (EdgeId edge_id = forward_side_.prev_edges[meeting_vertex]; edge_id != NO_EDGE;
+         edge_id = forward_side_.prev_edges[graph_.GetEdge(edge_id).from])
+    {
+        edges.push_back(edge_id);
+    }
+    std::reverse(edges.begin(), edges.end());
+    for (EdgeId edge_id = backward_side_.prev_edges[meeting_vertex]; edge_id != NO_EDGE;
+         edge_id = backward_side_.prev_edges[graph_.GetEdge(edge_id).to])
+    {
+        edges.push_back(edge_id);
+    }
+    // Вес пересчитывается по рёбрам в порядке пути, как у остальных движков
+    Weight weight{};
+    for (const EdgeId edge_id : edges) {
+        weight = weight + graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(edges)};
+}
+
+}  // namespace graph
@@ -1,28 +1,39 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
+#include <string_view>
 #include <vector>
 #include "geo.h"
+#include "ranges.h"
 
 namespace domain {
 	struct Bus;
 
+	// Имена хранит каталог, id — плотные порядковые номера в его массивах
 	struct Stop {
-		std::string name;
+		std::string_view name;
 		geo::Coordinates coordinates = {};
-		size_t id = 0;
+		uint32_t id = 0;
 	};
 
 	struct Bus {
-		std::string name;
-		std::vector<Stop*> bus_route;
+		std::string_view name;
+		std::vector<uint32_t> bus_route;	// id остановок
+		// Длины перегонов по ходу движения: lenghts[i] — от bus_route[i] до bus_route[i + 1],
+		// back_lenghts[i] — i-й перегон обратного пути некольцевого маршрута. NaN — расстояние не задано
+		std::vector<double> lenghts;
+		std::vector<double> back_lenghts;
 		bool is_roundtrip = false;
+		uint32_t id = 0;
 	};
 
+	// Длина перегона из длин вида Bus::lenghts; бросает std::invalid_argument, если она не задана
+	double GetSegmentLenght(ranges::Range<const double*> lenghts, size_t index);
+
 	struct BusRouteInfo {
 		double lenght = 0;
 		double curvature = 0;
 		int stops = 0;
 		int unique_stops = 0;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "router.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace graph {
+
+// Флойд–Уоршелл на целых весах в долях unit поверх графа с весами Weight: копия графа с округлёнными
+// весами, матрица вдвое меньше, чем на double, а сравнения точные и одинаковые на всех платформах.
+// Вес найденного пути пересчитывается по исходным рёбрам, поэтому времена в ответе не округлены
+template <typename Weight, typename FixedWeight = uint32_t>
+class FixedPointRouter : public RouteEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+    using FixedGraph = DirectedWeightedGraph<FixedWeight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    FixedPointRouter(const Graph& graph, Weight unit, bool use_huge_pages = false, const std::string& cache_file = {});
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    // Изменения переносятся в целочисленную копию графа, матрицу чинит Router
+    bool ApplyUpdates(const std::vector<EdgeUpdate<Weight>>& updates) override;
+
+private:
+    // Суммы путей не должны доходить до бесконечности (максимума типа), поэтому вес ребра ограничен
+    FixedWeight ToFixed(Weight weight) const {
+        const double fixed_weight = std::round(static_cast<double>(weight) / static_cast<double>(unit_));
+        if (!(fixed_weight <= static_cast<double>(MAX_EDGE_WEIGHT))) {
+            throw std::out_of_range("Edge weight does not fit the fixed-point type");
+        }
+        return static_cast<FixedWeight>(fixed_weight);
+    }
+
+    FixedGraph BuildFixedGraph() const {
+        FixedGraph fixed_graph(graph_.GetVertexCount());
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const Edge<Weight>& edge = graph_.GetEdge(edge_id);
+            fixed_graph.AddEdge({edge.from, edge.to, ToFixed(edge.weight)});
+        }
+        fixed_graph.Freeze();
+        return fixed_graph;
+    }
+
+    static constexpr FixedWeight MAX_EDGE_WEIGHT = std::numeric_limits<FixedWeight>::max() / 1024;
+    const Graph& graph_;
+    Weight unit_;
+    FixedGraph fixed_graph_;
+    Router<FixedWeight> fixed_router_;
+};
+
+template <typename Weight, typename FixedWeight>
+FixedPointRouter<Weight, FixedWeight>::FixedPointRouter(const Graph& graph, Weight unit, bool use_huge_pages,
+                                                        const std::string& cache_file)
+    : graph_(graph)
+    , unit_(unit)
+    , fixed_graph_(BuildFixedGraph())
+    , fixed_router_(fixed_graph_, use_huge_pages, cache_file)
+{
+}
+
+template <typename Weight, typename FixedWeight>
+std::optional<typename FixedPointRouter<Weight, FixedWeight>::RouteInfo>
+FixedPointRouter<Weight, FixedWeight>::BuildRoute(VertexId from, VertexId to) const {
+    std::optional<typename Router<FixedWeight>::RouteInfo> fixed_route = fixed_router_.BuildRoute(from, to);
+    if (!fixed_route) {
+        return std::nullopt;
+    }
+    Weight weight{};
+    for (const EdgeId edge_id : fixed_route->edges) {
+        weight += graph_.GetEdge(edge_id).weight;
+    }
+    return RouteInfo{weight, std::move(fixed_route->edges)};
+}
+
+template <typename Weight, typename FixedWeight>
+bool FixedPointRouter<Weight, FixedWeight>::ApplyUpdates(const std::vector<EdgeUpdate<Weight>>& updates) {
+    std::vector<EdgeUpdate<FixedWeight>> fixed_updates;
+    fixed_updates.reserve(updates.size());
+    if (fixed_graph_.GetVertexCount() != graph_.GetVertexCount()) {
+        fixed_graph_.Unfreeze();
+        fixed_graph_.AddVertices(graph_.GetVertexCount() - fixed_graph_.GetVertexCount());
+    }
+    for (const EdgeUpdate<Weight>& update : updates) {
+        const Edge<Weight>& edge = graph_.GetEdge(update.edge_id);
+        if (!update.old_weight) {
+            fixed_graph_.Unfreeze();
+            if (fixed_graph_.AddEdge({edge.from, edge.to, ToFixed(edge.weight)}) != update.edge_id) {
+                throw std::logic_error("New edges should be added in order of their ids");
+            }
+            fixed_updates.push_back({update.edge_id, std::nullopt});
+            continue;
+        }
+        const FixedWeight old_weight = fixed_graph_.GetEdge(update.edge_id).weight;
+        if (ToFixed(edge.weight) != old_weight) {
+            fixed_graph_.SetEdgeWeight(update.edge_id, ToFixed(edge.weight));
+            fixed_updates.push_back({update.edge_id, old_weight});
+        }
+    }
+    fixed_graph_.Freeze();
+    return fixed_router_.ApplyUpdates(fixed_updates);
+}
+
+}  // namespace graph
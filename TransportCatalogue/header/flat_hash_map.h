@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace transport_catalogue::detail {
+
+// Перемешивание хэша: std::hash для целых — тождественное, а индексы берутся из младших битов
+inline uint64_t MixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+// Хэш-таблица с открытой адресацией и линейным пробированием: ключи и значения лежат в одном
+// непрерывном массиве, поиск — один хэш и несколько соседних ячеек. Удаления нет
+template <typename Key, typename Value, typename Hasher = std::hash<Key>>
+class FlatHashMap {
+public:
+    // Вставляет пару, если ключа ещё нет. Возвращает значение в таблице и признак вставки
+    std::pair<Value*, bool> Insert(const Key& key, Value value);
+
+    const Value* Find(const Key& key) const;
+
+    Value* Find(const Key& key) {
+        return const_cast<Value*>(static_cast<const FlatHashMap&>(*this).Find(key));
+    }
+
+    void Reserve(size_t count);
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+private:
+    struct Slot {
+        Key key = {};
+        Value value = {};
+        bool occupied = false;
+    };
+
+    size_t GetSlot(const Key& key) const {
+        return MixHash(static_cast<uint64_t>(hasher_(key))) & (slots_.size() - 1);
+    }
+
+    void Rehash(size_t slot_count);
+
+    std::vector<Slot> slots_;
+    size_t size_ = 0;
+    Hasher hasher_;
+};
+
+template <typename Key, typename Value, typename Hasher>
+std::pair<Value*, bool> FlatHashMap<Key, Value, Hasher>::Insert(const Key& key, Value value) {
+    // Заполнение не больше 3/4, иначе цепочки пробирования резко растут
+    if ((size_ + 1) * 4 > slots_.size() * 3) {
+        Rehash(std::max<size_t>(slots_.size() * 2, 16));
+    }
+    for (size_t index = GetSlot(key);; index = (index + 1) & (slots_.size() - 1)) {
+        Slot& slot = slots_[index];
+        if (!slot.occupied) {
+            slot = {key, std::move(value), true};
+            ++size_;
+            return {&slot.value, true};
+        }
+        if (slot.key == key) {
+            return {&slot.value, false};
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+const Value* FlatHashMap<Key, Value, Hasher>::Find(const Key& key) const {
+    if (slots_.empty()) {
+        return nullptr;
+    }
+    for (size_t index = GetSlot(key);; index = (index + 1) & (slots_.size() - 1)) {
+        const Slot& slot = slots_[index];
+        if (!slot.occupied) {
+            return nullptr;
+        }
+        if (slot.key == key) {
+            return &slot.value;
+        }
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+void FlatHashMap<Key, Value, Hasher>::Reserve(size_t count) {
+    size_t slot_count = 16;
+    while (count * 4 > slot_count * 3) {
+        slot_count *= 2;
+    }
+    if (slot_count > slots_.size()) {
+        Rehash(slot_count);
+    }
+}
+
+template <typename Key, typename Value, typename Hasher>
+void FlatHashMap<Key, Value, Hasher>::Rehash(size_t slot_count) {
+    std::vector<Slot> old_slots(slot_count);
+    old_slots.swap(slots_);
+    size_ = 0;
+    for (Slot& slot : old_slots) {
+        if (slot.occupied) {
+            Insert(slot.key, std::move(slot.value));
+        }
+    }
+}
+
+// Минимальная по памяти совершенная хэш-функция по неизменному набору имён (hash and displace):
+// ключи разбиты на корзины, для каждой корзины подобрано зерно, при котором её ключи попадают
+// в свободные ячейки. В ячейках только id, имя кандидата сверяет владелец по своим данным, поэтому
+// один индекс разделяют каталог и его снимки. Поиск — ровно одна ячейка и одно сравнение строк
+class PerfectHashIndex {
+public:
+    PerfectHashIndex() = default;
+
+    // Пары имя — id; id должны быть ровно 0..items.size() - 1
+    explicit PerfectHashIndex(const std::vector<std::pair<std::string_view, uint32_t>>& items);
+
+    // key_of(id) — имя с этим id у владельца
+    template <typename KeyOf>
+    std::optional<uint32_t> Find(std::string_view key, KeyOf key_of) const {
+        if (slots_.empty()) {
+            return std::nullopt;
+        }
+        const uint64_t hash = std::hash<std::string_view>{}(key);
+        const uint32_t id = slots_[GetSlot(hash, seeds_[GetBucket(hash)])];
+        if (id == NO_ID || key_of(id) != key) {
+            return std::nullopt;
+        }
+        return id;
+    }
+
+    // Сколько имён в индексе: это id от 0 до GetSize() - 1
+    size_t GetSize() const {
+        return size_;
+    }
+
+private:
+    size_t GetBucket(uint64_t hash) const {
+        return MixHash(hash) % seeds_.size();
+    }
+
+    size_t GetSlot(uint64_t hash, uint32_t seed) const {
+        return MixHash(hash + seed * 0x9e3779b97f4a7c15ULL) % slots_.size();
+    }
+
+    bool TryBuild(const std::vector<std::pair<std::string_view, uint32_t>>& items, size_t slot_count);
+
+    static constexpr uint32_t NO_ID = UINT32_MAX;
+    static constexpr uint32_t MAX_SEED = 1u << 16;
+    std::vector<uint32_t> seeds_;
+    std::vector<uint32_t> slots_;	// id или NO_ID
+    size_t size_ = 0;
+};
+
+inline PerfectHashIndex::PerfectHashIndex(const std::vector<std::pair<std::string_view, uint32_t>>& items)
+    : size_(items.size()) {
+    if (items.empty()) {
+        return;
+    }
+    // Небольшой запас ячеек; если зерно для какой-то корзины не нашлось, таблица увеличивается
+    for (size_t slot_count = items.size() + items.size() / 4 + 1;; slot_count += slot_count / 2) {
+        if (TryBuild(items, slot_count)) {
+            return;
+        }
+    }
+}
+
+inline bool PerfectHashIndex::TryBuild(const std::vector<std::pair<std::string_view, uint32_t>>& items, size_t slot_count) {
+    seeds_.assign(items.size() / 4 + 1, 0);
+    slots_.assign(slot_count, NO_ID);
+    std::vector<uint64_t> hashes(items.size());
+    std::vector<std::vector<uint32_t>> buckets(seeds_.size());
+    for (size_t index = 0; index < items.size(); ++index) {
+        hashes[index] = std::hash<std::string_view>{}(items[index].first);
+        buckets[GetBucket(hashes[index])].push_back(static_cast<uint32_t>(index));
+    }
+    // Большие корзины размещаются первыми, пока свободных ячеек много
+    std::vector<uint32_t> order(buckets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t lhs, uint32_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+    std::vector<size_t> bucket_slots;
+    for (const uint32_t bucket : order) {
+        if (buckets[bucket].empty()) {
+            break;
+        }
+        uint32_t seed = 0;
+        for (; seed < MAX_SEED; ++seed) {
+            bucket_slots.clear();
+            for (const uint32_t item : buckets[bucket]) {
+                const size_t slot = GetSlot(hashes[item], seed);
+                if (slots_[slot] != NO_ID
+                    || std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end()) {
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+            if (bucket_slots.size() == buckets[bucket].size()) {
+                break;
+            }
+        }
+        if (seed == MAX_SEED) {
+            return false;
+        }
+        seeds_[bucket] = seed;
+        for (size_t index = 0; index < bucket_slots.size(); ++index) {
+            slots_[bucket_slots[index]] = items[buckets[bucket][index]].second;
+        }
+    }
+    return true;
+}
+
+}  // namespace transport_catalogue::detail
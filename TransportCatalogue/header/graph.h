@@ -3,6 +3,7 @@
 #include "ranges.h"
 
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -28,32 +29,129 @@ public:
     explicit DirectedWeightedGraph(size_t vertex_count);
     EdgeId AddEdge(const Edge<Weight>& edge);
 
+    // Упаковывает исходящие рёбра в сплошные массивы (CSR) по порядку вершин.
+    // После этого рёбра добавлять нельзя до Unfreeze, порядок рёбер у вершины сохраняется
+    void Freeze();
+    void Unfreeze();
+    bool IsFrozen() const;
+
+    // Новые вершины получают номера после имеющихся; только для незамороженного графа
+    VertexId AddVertices(size_t count);
+
+    // Меняет вес ребра в том числе в замороженном графе
+    void SetEdgeWeight(EdgeId edge_id, Weight weight);
+
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
     const Edge<Weight>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    // Обход исходящих рёбер: callback(edge_id, to, weight). В замороженном графе без обращения к edges_
+    template <typename Callback>
+    void ForEachOutgoing(VertexId vertex, Callback callback) const;
+
 private:
+    size_t vertex_count_ = 0;
     std::vector<Edge<Weight>> edges_;
     std::vector<IncidenceList> incidence_lists_;
+
+    // CSR: рёбра вершины v лежат в [offsets_[v], offsets_[v + 1])
+    bool frozen_ = false;
+    std::vector<size_t> offsets_;
+    std::vector<EdgeId> packed_edge_ids_;
+    std::vector<VertexId> packed_targets_;
+    std::vector<Weight> packed_weights_;
 };
 
 template <typename Weight>
 DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-    : incidence_lists_(vertex_count) {
+    : vertex_count_(vertex_count)
+    , incidence_lists_(vertex_count) {
 }
 
 template <typename Weight>
 EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+    if (frozen_) {
+        throw std::logic_error("Cannot add an edge to a frozen graph");
+    }
     edges_.push_back(edge);
     const EdgeId id = edges_.size() - 1;
     incidence_lists_.at(edge.from).push_back(id);
     return id;
 }
 
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Freeze() {
+    if (frozen_) {
+        return;
+    }
+    offsets_.assign(vertex_count_ + 1, 0);
+    packed_edge_ids_.reserve(edges_.size());
+    packed_targets_.reserve(edges_.size());
+    packed_weights_.reserve(edges_.size());
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        for (const EdgeId edge_id : incidence_lists_[vertex]) {
+            packed_edge_ids_.push_back(edge_id);
+            packed_targets_.push_back(edges_[edge_id].to);
+            packed_weights_.push_back(edges_[edge_id].weight);
+        }
+        offsets_[vertex + 1] = packed_edge_ids_.size();
+    }
+    std::vector<IncidenceList>().swap(incidence_lists_);
+    frozen_ = true;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::Unfreeze() {
+    if (!frozen_) {
+        return;
+    }
+    incidence_lists_.resize(vertex_count_);
+    for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+        incidence_lists_[vertex].assign(packed_edge_ids_.begin() + offsets_[vertex],
+                                        packed_edge_ids_.begin() + offsets_[vertex + 1]);
+    }
+    std::vector<size_t>().swap(offsets_);
+    std::vector<EdgeId>().swap(packed_edge_ids_);
+    std::vector<VertexId>().swap(packed_targets_);
+    std::vector<Weight>().swap(packed_weights_);
+    frozen_ = false;
+}
+
+template <typename Weight>
+bool DirectedWeightedGraph<Weight>::IsFrozen() const {
+    return frozen_;
+}
+
+template <typename Weight>
+VertexId DirectedWeightedGraph<Weight>::AddVertices(size_t count) {
+    if (frozen_) {
+        throw std::logic_error("Cannot add vertices to a frozen graph");
+    }
+    const VertexId first_vertex = vertex_count_;
+    vertex_count_ += count;
+    incidence_lists_.resize(vertex_count_);
+    return first_vertex;
+}
+
+template <typename Weight>
+void DirectedWeightedGraph<Weight>::SetEdgeWeight(EdgeId edge_id, Weight weight) {
+    Edge<Weight>& edge = edges_.at(edge_id);
+    edge.weight = weight;
+    if (!frozen_) {
+        return;
+    }
+    for (size_t i = offsets_[edge.from]; i < offsets_[edge.from + 1]; ++i) {
+        if (packed_edge_ids_[i] == edge_id) {
+            packed_weights_[i] = weight;
+            return;
+        }
+    }
+}
+
 template <typename Weight>
 size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-    return incidence_lists_.size();
+    return vertex_count_;
 }
 
 template <typename Weight>
@@ -69,6 +167,74 @@ const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const
 template <typename Weight>
 typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
 DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+    if (frozen_) {
+        if (vertex >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        return {packed_edge_ids_.begin() + offsets_[vertex], packed_edge_ids_.begin() + offsets_[vertex + 1]};
+    }
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
-}  // namespace graph
\ No newline at end of file
+
+template <typename Weight>
+template <typename Callback>
+void DirectedWeightedGraph<Weight>::ForEachOutgoing(VertexId vertex, Callback callback) const {
+    if (frozen_) {
+        const size_t end = offsets_[vertex + 1];
+        for (size_t i = offsets_[vertex]; i < end; ++i) {
+            callback(packed_edge_ids_[i], packed_targets_[i], packed_weights_[i]);
+        }
+        return;
+    }
+    for (const EdgeId edge_id : incidence_lists_[vertex]) {
+        const Edge<Weight>& edge = edges_[edge_id];
+        callback(edge_id, edge.to, edge.weight);
+    }
+}
+
+// Входящие рёбра графа в виде CSR: для обратного поиска без копии графа с развёрнутыми рёбрами.
+// Ссылается на исходный граф, EdgeId общие
+template <typename Weight>
+class ReverseAdjacency {
+public:
+    explicit ReverseAdjacency(const DirectedWeightedGraph<Weight>& graph);
+
+    // callback(edge_id, from, weight) для каждого ребра, входящего в vertex
+    template <typename Callback>
+    void ForEachIncoming(VertexId vertex, Callback callback) const {
+        const size_t end = offsets_[vertex + 1];
+        for (size_t i = offsets_[vertex]; i < end; ++i) {
+            callback(edge_ids_[i], sources_[i], weights_[i]);
+        }
+    }
+
+private:
+    std::vector<size_t> offsets_;
+    std::vector<EdgeId> edge_ids_;
+    std::vector<VertexId> sources_;
+    std::vector<Weight> weights_;
+};
+
+template <typename Weight>
+ReverseAdjacency<Weight>::ReverseAdjacency(const DirectedWeightedGraph<Weight>& graph)
+    : offsets_(graph.GetVertexCount() + 1, 0)
+    , edge_ids_(graph.GetEdgeCount())
+    , sources_(graph.GetEdgeCount())
+    , weights_(graph.GetEdgeCount()) {
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        ++offsets_[graph.GetEdge(edge_id).to + 1];
+    }
+    for (VertexId vertex = 0; vertex < graph.GetVertexCount(); ++vertex) {
+        offsets_[vertex + 1] += offsets_[vertex];
+    }
+    std::vector<size_t> positions(offsets_.begin(), offsets_.end() - 1);
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        const Edge<Weight>& edge = graph.GetEdge(edge_id);
+        const size_t position = positions[edge.to]++;
+        edge_ids_[position] = edge_id;
+        sources_[position] = edge.from;
+        weights_[position] = edge.weight;
+    }
+}
+
+}  // namespace graph
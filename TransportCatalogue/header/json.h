@@ -3,7 +3,9 @@
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <variant>
 
@@ -12,7 +14,18 @@ namespace json {
     class Node;
     using Dict = std::map<std::string, Node>;
     using Array = std::vector<Node>;
-    using JsonType = std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string>;
+
+    // Готовый фрагмент JSON, при печати копируется как есть. Текст общий для всех копий узла,
+    // поэтому один закэшированный фрагмент можно вставлять в любое число ответов без копирования
+    struct RawJson {
+        std::shared_ptr<const std::string> text;
+    };
+
+    inline bool operator==(const RawJson& lhs, const RawJson& rhs) {
+        return lhs.text == rhs.text || (lhs.text != nullptr && rhs.text != nullptr && *lhs.text == *rhs.text);
+    }
+
+    using JsonType = std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string, RawJson>;
     using Number = std::variant<int, double>;
 
     // Эта ошибка должна выбрасываться при ошибках парсинга JSON
@@ -21,7 +34,7 @@ namespace json {
         using runtime_error::runtime_error;
     };
 
-    class Node : private  std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+    class Node : private  std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string, RawJson> {
     public:
 
         using variant::variant;
@@ -90,6 +103,8 @@ namespace json {
 
     void PrintObj(std::ostream& output, const Array& array);
 
+    void PrintObj(std::ostream& output, const RawJson& raw);
+
     void Print(const Document& doc, std::ostream& output);
 
 }  // namespace json
@@ -27,6 +27,7 @@ namespace transport_catalogue::store {
         void operator()(const double& value);
         void operator()(const int& value );
         void operator()(const std::string& line);
+        void operator()(const json::RawJson& raw);
         std::string key;
         std::string type_data;
         DataStop* data_stop = nullptr;
@@ -41,7 +42,10 @@ namespace transport_catalogue::store {
 
     json::Node SaveEmptyAnswer(const json::Node& value);
     
-    json::Node RequestStop(const RequestHandler& handler, const json::Node& value);
+    // stop_buses_json — сериализованные списки "buses" по id остановки, заполняются при первом запросе остановки;
+    // ответ делит с кэшем владение текстом, так что узел можно копировать и хранить сколько угодно
+    json::Node RequestStop(const RequestHandler& handler, const json::Node& value,
+        std::vector<std::shared_ptr<const std::string>>& stop_buses_json);
     
     json::Node RequestBus(const RequestHandler& handler, const json::Node& value);
 
@@ -56,7 +60,33 @@ namespace transport_catalogue::store {
     double CalcTotalTime(const std::vector<route::RouteData>& route_data);
     
     json::Node RequestRoute(const RequestHandler& handler, const json::Node& value);
+
+    json::Node CreateRouteAnswer(const json::Node& value, const std::optional<std::vector<route::RouteData>>& route_data);
+
+    // Запрос Route с "pareto": true — все недоминируемые по времени и пересадкам варианты
+    bool IsParetoRequest(const json::Node& value);
+
+    json::Node RequestParetoRoute(const RequestHandler& handler, const json::Node& value);
+
+    // Запрос Route с "alternatives": k — быстрейший маршрут и до k альтернатив; 0, если поля нет
+    size_t ReadAlternativesCount(const json::Node& value);
+
+    json::Node RequestAlternativeRoutes(const RequestHandler& handler, const json::Node& value);
+
+    // Ответы на все запросы Route массива stat_requests, по индексу запроса
+    std::vector<json::Node> RequestRoutes(const RequestHandler& handler, const json::Node& node);
     
+    std::vector<std::string_view> ReadStopNames(const json::Node& node);
+
+    // Запрос Matrix: времена в пути в минутах для всех пар остановок "from" × "to"
+    json::Node RequestMatrix(const RequestHandler& handler, const json::Node& value);
+
+    // Запрос Isochrone: остановки, до которых из "from" не дольше "max_time" минут
+    json::Node RequestIsochrone(const RequestHandler& handler, const json::Node& value);
+
+    // Есть ли запросы, которым нужен маршрутизатор (Route, Matrix, Isochrone)
+    bool HasRouteRequests(const json::Node& node);
+
     void StatRequests(const json::Node& node, const RequestHandler& handler);
 
     void BaseRequests(const json::Node& node, TransportCatalogue& catalogue);
@@ -65,6 +95,10 @@ namespace transport_catalogue::store {
 
     void ReadSetting(const json::Node& node, renderer::Settings& settings);
 
+    route::RouterEngine ReadRouterEngine(const json::Node& node);
+
+    route::GraphModel ReadGraphModel(const json::Node& node);
+
     void ReadRouteSetting(const json::Node& node, route::RouteSettings& route_settings);
 
     void ReadRequests(std::istream& input, TransportCatalogue& catalogue);
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "router.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// k кратчайших путей без повторных вершин (алгоритм Йена). Обратное дерево кратчайших путей до цели
+// строится один раз на цель: по нему сразу читается первый путь, а его веса — точная нижняя оценка
+// для A* в поисках ответвлений, которые поэтому почти не отходят от оптимального продолжения
+template <typename Weight>
+class KShortestPaths {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    explicit KShortestPaths(const Graph& graph);
+
+    // До count путей из from в to по возрастанию веса. accept(route) отбраковывает пути: отбракованные
+    // в ответ не идут и не считаются, но ответвления от них ищутся. Всего перебирается не больше max_paths путей
+    template <typename Accept>
+    std::vector<RouteInfo> BuildRoutes(VertexId from, VertexId to, size_t count, size_t max_paths, Accept accept) const;
+
+private:
+    struct QueueItem {
+        Weight key;
+        VertexId vertex;
+
+        bool operator>(const QueueItem& other) const {
+            return key > other.key;
+        }
+    };
+
+    // Кандидаты упорядочены по весу, одинаковые пути из разных ответвлений схлопываются
+    using Candidate = std::pair<Weight, std::vector<EdgeId>>;
+
+    bool IsReachable(VertexId vertex) const {
+        return target_weights_[vertex] < INFINITE_WEIGHT;
+    }
+
+    void NextStamp() const {
+        if (++stamp_ == 0) {
+            std::fill(reached_stamps_.begin(), reached_stamps_.end(), 0);
+            std::fill(settled_stamps_.begin(), settled_stamps_.end(), 0);
+            std::fill(blocked_vertex_stamps_.begin(), blocked_vertex_stamps_.end(), 0);
+            std::fill(blocked_edge_stamps_.begin(), blocked_edge_stamps_.end(), 0);
+            stamp_ = 1;
+        }
+    }
+
+    // Обратная Дейкстра от to: вес пути до цели и первое ребро на нём для каждой вершины
+    void PrepareTarget(VertexId to) const;
+
+    // A* от spur до цели в обход заблокированных на этом шаге вершин и рёбер
+    std::optional<Candidate> SearchSpur(VertexId spur) const;
+
+    static constexpr Weight ZERO_WEIGHT{};
+    static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::max();
+    static constexpr EdgeId NO_EDGE = std::numeric_limits<EdgeId>::max();
+    const Graph& graph_;
+    ReverseAdjacency<Weight> reverse_;
+
+    mutable VertexId target_ = std::numeric_limits<VertexId>::max();
+    mutable std::vector<Weight> target_weights_;
+    mutable std::vector<EdgeId> next_edges_;
+
+    mutable std::vector<Weight> weights_;
+    mutable std::vector<EdgeId> prev_edges_;
+    mutable std::vector<uint32_t> reached_stamps_;
+    mutable std::vector<uint32_t> settled_stamps_;
+    mutable std::vector<uint32_t> blocked_vertex_stamps_;
+    mutable std::vector<uint32_t> blocked_edge_stamps_;
+    mutable std::vector<QueueItem> queue_;
+    mutable uint32_t stamp_ = 0;
+};
+
+template <typename Weight>
+KShortestPaths<Weight>::KShortestPaths(const Graph& graph)
+    : graph_(graph)
+    , reverse_(graph)
+    , target_weights_(graph.GetVertexCount())
+    , next_edges_(graph.GetVertexCount())
+    , weights_(graph.GetVertexCount())
+    , prev_edges_(graph.GetVertexCount())
+    , reached_stamps_(graph.GetVertexCount(), 0)
+    , settled_stamps_(graph.GetVertexCount(), 0)
+    , blocked_vertex_stamps_(graph.GetVertexCount(), 0)
+    , blocked_edge_stamps_(graph.GetEdgeCount(), 0)
+{
+    for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+        if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+    }
+}
+
+template <typename Weight>
+void KShortestPaths<Weight>::PrepareTarget(VertexId to) const {
+    if (to == target_) {
+        return;
+    }
+    target_ = to;
+    std::fill(target_weights_.begin(), target_weights_.end(), INFINITE_WEIGHT);
+    std::fill(next_edges_.begin(), next_edges_.end(), NO_EDGE);
+    target_weights_[to] = ZERO_WEIGHT;
+    std::vector<QueueItem> queue{{ZERO_WEIGHT, to}};
+    while (!queue.empty()) {
+        std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+        const QueueItem item = queue.back();
+        queue.pop_back();
+        if (target_weights_[item.vertex] < item.key) {
+            continue;
+        }
+        reverse_.ForEachIncoming(item.vertex, [&](EdgeId edge_id, VertexId from, Weight weight) {
+            if (item.key + weight < target_weights_[from]) {
+                target_weights_[from] = item.key + weight;
+                next_edges_[from] = edge_id;
+                queue.push_back({target_weights_[from], from});
+                std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+            }
+        });
+    }
+}
+
+template <typename Weight>
+std::optional<typename KShortestPaths<Weight>::Candidate> KShortestPaths<Weight>::SearchSpur(VertexId spur) const {
+    const auto reach = [this](VertexId vertex, Weight weight, EdgeId prev_edge) {
+        reached_stamps_[vertex] = stamp_;
+        weights_[vertex] = weight;
+        prev_edges_[vertex] = prev_edge;
+        queue_.push_back({weight + target_weights_[vertex], vertex});
+        std::push_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+    };
+    queue_.clear();
+    reach(spur, ZERO_WEIGHT, NO_EDGE);
+    while (!queue_.empty()) {
+        std::pop_heap(queue_.begin(), queue_.end(), std::greater<QueueItem>{});
+        const VertexId vertex = queue_.back().vertex;
+        queue_.pop_back();
+        if (settled_stamps_[vertex] == stamp_) {
+            continue;
+        }
+        settled_stamps_[vertex] = stamp_;
+        if (vertex == target_) {
+            std::vector<EdgeId> edges;
+            for (EdgeId edge_id = prev_edges_[vertex]; edge_id != NO_EDGE; edge_id = prev_edges_[graph_.GetEdge(edge_id).from]) {
+                edges.push_back(edge_id);
+            }
+            std::reverse(edges.begin(), edges.end());
+            return Candidate{weights_[vertex], std::move(edges)};
+        }
+        const Weight vertex_weight = weights_[vertex];
+        graph_.ForEachOutgoing(vertex, [&](EdgeId edge_id, VertexId to, Weight weight) {
+            if (settled_stamps_[to] == stamp_ || blocked_vertex_stamps_[to] == stamp_
+                || blocked_edge_stamps_[edge_id] == stamp_ || !IsReachable(to)) {
+                return;
+            }
+            const Weight candidate_weight = vertex_weight + weight;
+            if (reached_stamps_[to] != stamp_ || candidate_weight < weights_[to]) {
+                reach(to, candidate_weight, edge_id);
+            }
+        });
+    }
+    return std::nullopt;
+}
+
+template <typename Weight>
+template <typename Accept>
+std::vector<typename KShortestPaths<Weight>::RouteInfo> KShortestPaths<Weight>::BuildRoutes(VertexId from, VertexId to,
+                                                                                            size_t count, size_t max_paths,
+                                                                                            Accept accept) const {
+    if (from >= graph_.GetVertexCount() || to >= graph_.GetVertexCount()) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    std::vector<RouteInfo> routes;
+    PrepareTarget(to);
+    if (!IsReachable(from) || count == 0) {
+        return routes;
+    }
+
+    std::vector<RouteInfo> paths;
+    std::vector<EdgeId> first_edges;
+    for (VertexId vertex = from; vertex != to; vertex = graph_.GetEdge(next_edges_[vertex]).to) {
+        first_edges.push_back(next_edges_[vertex]);
+    }
+    paths.push_back(RouteInfo{target_weights_[from], std::move(first_edges)});
+    std::set<Candidate> candidates;
+    while (true) {
+        const RouteInfo& path = paths.back();
+        if (accept(path)) {
+            routes.push_back(path);
+            if (routes.size() == count) {
+                break;
+            }
+        }
+        if (paths.size() >= max_paths) {
+            break;
+        }
+
+        // Ответвление в каждой вершине пути: корень до неё общий, первое ребро после — не как у найденных путей,
+        // а вершины корня повторно не посещаются
+        Weight root_weight = ZERO_WEIGHT;
+        std::vector<VertexId> root_vertices;
+        VertexId spur = from;
+        for (size_t index = 0; index < path.edges.size(); ++index) {
+            NextStamp();
+            for (const VertexId vertex : root_vertices) {
+                blocked_vertex_stamps_[vertex] = stamp_;
+            }
+            for (const RouteInfo& other : paths) {
+                if (other.edges.size() > index && std::equal(path.edges.begin(), path.edges.begin() + index, other.edges.begin())) {
+                    blocked_edge_stamps_[other.edges[index]] = stamp_;
+                }
+            }
+            if (std::optional<Candidate> spur_path = SearchSpur(spur)) {
+                std::vector<EdgeId> edges(path.edges.begin(), path.edges.begin() + index);
+                edges.insert(edges.end(), spur_path->second.begin(), spur_path->second.end());
+                candidates.emplace(root_weight + spur_path->first, std::move(edges));
+            }
+            const Edge<Weight>& edge = graph_.GetEdge(path.edges[index]);
+            root_vertices.push_back(spur);
+            root_weight += edge.weight;
+            spur = edge.to;
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        auto best = candidates.extract(candidates.begin());
+        paths.push_back(RouteInfo{best.value().first, std::move(best.value().second)});
+    }
+    return routes;
+}
+
+}  // namespace graph
@@ -4,8 +4,9 @@
 #include "svg.h"
 #include "domain.h"
 #include <algorithm>
+#include <set>
 #include <unordered_map>
-#include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 
 namespace renderer {
     using namespace transport_catalogue::store;
@@ -89,11 +90,11 @@ namespace renderer {
 	public:
 		MapRenderer(const Settings& settings);
         const Settings& GetSetting() const;
-        std::optional<svg::Polyline> CreateRouteLine(const domain::Bus* bus, const SphereProjector& sphere_proj) const;
-        std::vector<std::pair<svg::Text,svg::Text>> CreateRouteName(const domain::Bus* bus, const SphereProjector& sphere_proj) const;
+        std::optional<svg::Polyline> CreateRouteLine(const BusView* bus, const CatalogueSnapshot& catalogue, const SphereProjector& sphere_proj) const;
+        std::vector<std::pair<svg::Text,svg::Text>> CreateRouteName(const BusView* bus, const CatalogueSnapshot& catalogue, const SphereProjector& sphere_proj) const;
         svg::Circle CreateStopsSymbol(const domain::Stop* stop, const SphereProjector& sphere_proj) const;
         std::pair<svg::Text, svg::Text> CreateStopsName(const domain::Stop* stop, const SphereProjector& sphere_proj) const;
-        svg::Document CreateMap(const TransportCatalogue& catalogue) const;
+        svg::Document CreateMap(const CatalogueSnapshot& catalogue) const;
         void ResetColorCount() const;
     private:
         void ChangeCountColor();
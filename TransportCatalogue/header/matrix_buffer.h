@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace graph::detail {
+
+// Непрерывный буфер под матрицы маршрутов, выделяется одним куском.
+// На Linux большие буферы можно разместить на huge pages (madvise), иначе — обычный operator new.
+// Также может быть отображением файла только для чтения (MapFile)
+class MatrixBuffer {
+public:
+    MatrixBuffer() = default;
+
+    MatrixBuffer(size_t size, bool use_huge_pages)
+        : size_(size) {
+        if (size_ == 0) {
+            return;
+        }
+#if defined(__linux__)
+        if (use_huge_pages && size_ >= HUGE_PAGE_SIZE) {
+            void* data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (data != MAP_FAILED) {
+                madvise(data, size_, MADV_HUGEPAGE);
+                data_ = data;
+                mapped_ = true;
+                return;
+            }
+        }
+#else
+        (void)use_huge_pages;
+#endif
+        data_ = ::operator new(size_, std::align_val_t{ALIGNMENT});
+    }
+
+    // Отображает файл целиком в память только для чтения, без копирования.
+    // nullopt, если файл не открылся или отображение не поддерживается
+    static std::optional<MatrixBuffer> MapFile(const std::string& path) {
+#if defined(__linux__)
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        struct stat file_stat {};
+        void* data = MAP_FAILED;
+        if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+            data = mmap(nullptr, static_cast<size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (data == MAP_FAILED) {
+            return std::nullopt;
+        }
+        MatrixBuffer buffer;
+        buffer.data_ = data;
+        buffer.size_ = static_cast<size_t>(file_stat.st_size);
+        buffer.mapped_ = true;
+        return buffer;
+#else
+        (void)path;
+        return std::nullopt;
+#endif
+    }
+
+    MatrixBuffer(const MatrixBuffer&) = delete;
+    MatrixBuffer& operator=(const MatrixBuffer&) = delete;
+
+    MatrixBuffer(MatrixBuffer&& other) noexcept {
+        Swap(other);
+    }
+
+    MatrixBuffer& operator=(MatrixBuffer&& other) noexcept {
+        if (this != &other) {
+            MatrixBuffer(std::move(other)).Swap(*this);
+        }
+        return *this;
+    }
+
+    ~MatrixBuffer() {
+        if (data_ == nullptr) {
+            return;
+        }
+#if defined(__linux__)
+        if (mapped_) {
+            munmap(data_, size_);
+            return;
+        }
+#endif
+        ::operator delete(data_, std::align_val_t{ALIGNMENT});
+    }
+
+    void* GetData() const {
+        return data_;
+    }
+
+    size_t GetSize() const {
+        return size_;
+    }
+
+private:
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    void Swap(MatrixBuffer& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(mapped_, other.mapped_);
+    }
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+};
+
+}  // namespace graph::detail
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "dijkstra_router.h"
+
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace graph {
+
+// LRU-кэш деревьев кратчайших путей по начальной вершине с ограничением по памяти
+template <typename Weight>
+class ShortestPathTreeCache {
+public:
+    using Tree = ShortestPathTree<Weight>;
+
+    explicit ShortestPathTreeCache(size_t memory_budget)
+        : memory_budget_(memory_budget) {
+    }
+
+    // Возвращает дерево из кэша либо строит его через build_tree(root) и запоминает,
+    // вытесняя давно не использованные. Дерево больше бюджета живёт до следующего промаха
+    template <typename BuildTree>
+    const Tree& GetOrBuild(VertexId root, BuildTree build_tree) {
+        if (const auto it = index_.find(root); it != index_.end()) {
+            ++hit_count_;
+            trees_.splice(trees_.begin(), trees_, it->second);
+            return trees_.front();
+        }
+        ++miss_count_;
+        Tree tree = build_tree(root);
+        const size_t tree_size = tree.GetMemorySize();
+        while (!trees_.empty() && memory_size_ + tree_size > memory_budget_) {
+            Evict();
+        }
+        memory_size_ += tree_size;
+        trees_.push_front(std::move(tree));
+        index_[root] = trees_.begin();
+        return trees_.front();
+    }
+
+    // Удаляет деревья, для которых predicate(tree) истинно; возвращает их число
+    template <typename Predicate>
+    size_t EraseIf(Predicate predicate) {
+        size_t erased_count = 0;
+        for (auto it = trees_.begin(); it != trees_.end();) {
+            if (predicate(static_cast<const Tree&>(*it))) {
+                memory_size_ -= it->GetMemorySize();
+                index_.erase(it->root);
+                it = trees_.erase(it);
+                ++erased_count;
+            }
+            else {
+                ++it;
+            }
+        }
+        return erased_count;
+    }
+
+    void Clear() {
+        trees_.clear();
+        index_.clear();
+        memory_size_ = 0;
+    }
+
+    size_t GetHitCount() const {
+        return hit_count_;
+    }
+
+    size_t GetMissCount() const {
+        return miss_count_;
+    }
+
+    size_t GetTreeCount() const {
+        return trees_.size();
+    }
+
+    size_t GetMemorySize() const {
+        return memory_size_;
+    }
+
+    size_t GetMemoryBudget() const {
+        return memory_budget_;
+    }
+
+private:
+    void Evict() {
+        memory_size_ -= trees_.back().GetMemorySize();
+        index_.erase(trees_.back().root);
+        trees_.pop_back();
+    }
+
+    size_t memory_budget_ = 0;
+    size_t memory_size_ = 0;
+    size_t hit_count_ = 0;
+    size_t miss_count_ = 0;
+    std::list<Tree> trees_;
+    std::unordered_map<VertexId, typename std::list<Tree>::iterator> index_;
+};
+
+}  // namespace graph
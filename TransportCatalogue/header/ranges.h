@@ -12,6 +12,8 @@ class Range {
 public:
     using ValueType = typename std::iterator_traits<It>::value_type;
 
+    Range() = default;
+
     Range(It begin, It end)
         : begin_(begin)
         , end_(end) {
@@ -22,10 +24,31 @@ public:
     It end() const {
         return end_;
     }
+    std::reverse_iterator<It> rbegin() const {
+        return std::reverse_iterator<It>(end_);
+    }
+    std::reverse_iterator<It> rend() const {
+        return std::reverse_iterator<It>(begin_);
+    }
+    size_t size() const {
+        return static_cast<size_t>(std::distance(begin_, end_));
+    }
+    bool empty() const {
+        return begin_ == end_;
+    }
+    decltype(auto) operator[](size_t index) const {
+        return *std::next(begin_, index);
+    }
+    decltype(auto) front() const {
+        return *begin_;
+    }
+    decltype(auto) back() const {
+        return *std::prev(end_);
+    }
 
 private:
-    It begin_;
-    It end_;
+    It begin_ = {};
+    It end_ = {};
 };
 
 template <typename C>
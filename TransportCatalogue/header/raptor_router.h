@@ -0,0 +1,87 @@
+#pragma once
+
+#include "transport_router.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace route {
+
+	// Поиск по раундам (RAPTOR) прямо по маршрутам автобусов, без графа.
+	// Раунд k даёт лучшие времена прибытия не более чем с k посадками; сканируются только проходы
+	// автобусов через остановки, улучшенные в предыдущем раунде. Ожидание и скорость — из RouteSettings
+	class RaptorRouter {
+	public:
+		RaptorRouter(const CatalogueSnapshot& catalogue, const RouteSettings& route_setting);
+
+		// from и to — идентификаторы остановок (Stop::id)
+		std::optional<std::vector<RouteData>> BuildRoute(size_t from, size_t to) const;
+
+		// Парето-множество поездок по (времени, числу пересадок): по одной на каждое число посадок,
+		// при котором время строго лучше, чем с меньшим числом. Упорядочено по возрастанию пересадок
+		std::vector<std::vector<RouteData>> BuildParetoRoutes(size_t from, size_t to) const;
+
+		// Лучшие времена в секундах из from до каждой из targets за один прогон раундов
+		std::vector<std::optional<double>> BuildTimes(size_t from, const std::vector<size_t>& targets) const;
+
+		// Остановки, достижимые из from не дольше max_time секунд, со временем прибытия, по возрастанию времени.
+		// Поездки, прибывающие позже max_time, отсекаются прямо в раундах
+		std::vector<std::pair<size_t, double>> BuildReachable(size_t from, double max_time) const;
+
+	private:
+		static constexpr uint32_t NO_PATTERN = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+		static constexpr size_t NO_STOP = std::numeric_limits<size_t>::max();
+		static constexpr double INFINITE_TIME = std::numeric_limits<double>::infinity();
+
+		// Проход автобуса в одном направлении; остановки и накопленные расстояния лежат в общих массивах
+		struct Pattern {
+			std::string_view bus_name = {};
+			uint32_t begin = 0;
+			uint32_t size = 0;
+		};
+
+		// Как остановка достигнута: проход, позиции посадки и высадки в нём
+		struct Label {
+			uint32_t pattern = NO_PATTERN;
+			uint32_t board_index = 0;
+			uint32_t alight_index = 0;
+		};
+
+		const RouteSettings& route_setting_;
+		size_t stop_count_ = 0;
+		std::vector<std::string_view> stop_names_;
+
+		std::vector<Pattern> patterns_;
+		std::vector<uint32_t> pattern_stops_;
+		std::vector<double> pattern_distances_;	// от начала прохода, в метрах
+		// Проходы через остановку (номер прохода, позиция в нём), разложены по остановкам подряд
+		std::vector<uint32_t> stop_pattern_offsets_;
+		std::vector<std::pair<uint32_t, uint32_t>> stop_patterns_;
+
+		mutable std::vector<std::vector<double>> arrivals_;	// по раундам
+		mutable std::vector<std::vector<Label>> labels_;
+		mutable std::vector<double> best_arrivals_;
+		mutable std::vector<char> marked_stops_;
+		mutable std::vector<uint32_t> marked_list_;
+		mutable std::vector<uint32_t> pattern_starts_;
+		mutable std::vector<uint32_t> queued_patterns_;
+
+		void AddPattern(std::string_view bus_name, const std::vector<uint32_t>& stops, const std::vector<double>& distances);
+
+		// Прогоняет раунды из from с отсечением по времени у to (NO_STOP — без цели) и по max_time;
+		// возвращает номер последнего раунда
+		size_t RunRounds(size_t from, size_t to, double max_time = INFINITE_TIME) const;
+
+		// Раунд round по отметкам предыдущего; возвращает false, если сканировать нечего
+		bool ScanRound(size_t round, size_t to, double max_time) const;
+
+		std::vector<RouteData> ExtractRoute(size_t round, size_t to) const;
+
+		double GetRideTime(uint32_t pattern, uint32_t board_index, uint32_t alight_index) const;
+	};
+}
@@ -2,7 +2,7 @@
 
 #include <optional>
 
-#include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "map_renderer.h"
 #include "transport_router.h"
 
@@ -11,20 +11,47 @@ namespace req_handler {
     using namespace route;
     class RequestHandler {
     public:
-        RequestHandler(const TransportCatalogue& catalogue, const renderer::MapRenderer& renderer, const TransportRouter& router);
+        // router может отсутствовать, если в запросах нет построения маршрутов
+        RequestHandler(const CatalogueSnapshot& catalogue, const renderer::MapRenderer& renderer, const TransportRouter* router);
 
         // Возвращает информацию о маршруте (запрос Bus)
         std::optional<BusRouteInfo> GetBusStat(const std::string_view& bus_name) const;
 
-        // Возвращает маршруты, проходящие через остановку
-        const std::set<std::string_view>* GetBusesByStop(const std::string_view& stop_name) const;
+        // Возвращает маршруты, проходящие через остановку, по алфавиту
+        std::optional<ranges::Range<const std::string_view*>> GetBusesByStop(const std::string_view& stop_name) const;
+
+        // То же по id остановки из GetStopId
+        ranges::Range<const std::string_view*> GetBusesByStop(uint32_t stop_id) const;
+
+        // id остановки в справочнике (от 0 до GetStopCount()); nullopt, если остановки нет
+        std::optional<uint32_t> GetStopId(const std::string_view& stop_name) const;
+
+        size_t GetStopCount() const;
 
         svg::Document RenderMap() const;
 
         std::optional<std::vector<route::RouteData>> CreateRoute(const std::string_view& from, const std::string_view& to) const;
+
+        // Пакет маршрутов из одной остановки, ответы в порядке to_list
+        std::vector<std::optional<std::vector<route::RouteData>>> CreateRoutes(const std::string_view& from,
+            const std::vector<std::string_view>& to_list) const;
+
+        // Матрица времён в пути в минутах; nullopt, если нет маршрутизатора или неизвестна остановка
+        std::optional<route::TransportRouter::TimeMatrix> CreateTimeMatrix(const std::vector<std::string_view>& from_list,
+            const std::vector<std::string_view>& to_list) const;
+
+        // Остановки в пределах max_time минут от from; nullopt, если нет маршрутизатора или неизвестна остановка
+        std::optional<std::vector<route::ReachableStop>> CreateIsochrone(const std::string_view& from, double max_time) const;
+
+        // Быстрейший маршрут и до alternatives_count альтернатив, по возрастанию времени
+        std::vector<std::vector<route::RouteData>> CreateAlternativeRoutes(const std::string_view& from, const std::string_view& to,
+            size_t alternatives_count) const;
+
+        // Маршруты, недоминируемые по времени и числу пересадок
+        std::vector<std::vector<route::RouteData>> CreateParetoRoutes(const std::string_view& from, const std::string_view& to) const;
     private:
-        const TransportCatalogue& catalogue_;
+        const CatalogueSnapshot& catalogue_;
         const renderer::MapRenderer& renderer_;
-        const route::TransportRouter& router_;
+        const route::TransportRouter* router_;
     };
 }
\ No newline at end of file
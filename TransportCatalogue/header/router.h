@@ -1,117 +1,615 @@
 #pragma once
 
 #include "graph.h"
+#include "matrix_buffer.h"
 
 #include <algorithm>
 #include <cassert>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
 namespace graph {
 
+// Изменение графа после построения движка: новое ребро (old_weight == nullopt) или ребро с новым весом
 template <typename Weight>
-class Router {
-private:
-    using Graph = DirectedWeightedGraph<Weight>;
+struct EdgeUpdate {
+    EdgeId edge_id = 0;
+    std::optional<Weight> old_weight;
+};
 
+// Общий интерфейс движков поиска кратчайшего пути
+template <typename Weight>
+class RouteEngine {
 public:
-    explicit Router(const Graph& graph);
-
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
-    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    virtual ~RouteEngine() = default;
+
+    virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+    // Маршруты из одной вершины в несколько, в порядке targets. По умолчанию — отдельный запрос на каждую цель
+    virtual std::vector<std::optional<RouteInfo>> BuildRoutes(VertexId from, const std::vector<VertexId>& targets) const {
+        std::vector<std::optional<RouteInfo>> routes;
+        routes.reserve(targets.size());
+        for (const VertexId to : targets) {
+            routes.push_back(BuildRoute(from, to));
+        }
+        return routes;
+    }
+
+    // Веса кратчайших путей sources × targets без восстановления маршрутов; nullopt — пути нет
+    using DistanceTable = std::vector<std::vector<std::optional<Weight>>>;
+
+    virtual DistanceTable BuildDistanceTable(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const {
+        DistanceTable table;
+        table.reserve(sources.size());
+        for (const VertexId from : sources) {
+            std::vector<std::optional<Weight>>& row = table.emplace_back();
+            row.reserve(targets.size());
+            for (const std::optional<RouteInfo>& route : BuildRoutes(from, targets)) {
+                row.push_back(route ? std::optional<Weight>(route->weight) : std::nullopt);
+            }
+        }
+        return table;
+    }
+
+    // Подстраивает предрасчёт под уже изменённый граф (рёбра и вершины только добавлялись).
+    // false — движок так не умеет и его нужно построить заново
+    virtual bool ApplyUpdates(const std::vector<EdgeUpdate<Weight>>& updates) {
+        (void)updates;
+        return false;
+    }
+};
+
+namespace detail {
+
+// Многоразовый барьер для синхронизации фаз параллельного Флойда–Уоршелла
+class PhaseBarrier {
+public:
+    explicit PhaseBarrier(size_t thread_count)
+        : thread_count_(thread_count) {
+    }
+
+    void Wait() {
+        std::unique_lock lock(mutex_);
+        const size_t generation = generation_;
+        if (++waiting_count_ == thread_count_) {
+            waiting_count_ = 0;
+            ++generation_;
+            condition_.notify_all();
+            return;
+        }
+        condition_.wait(lock, [this, generation] {
+            return generation != generation_;
+        });
+    }
 
 private:
-    struct RouteInternalData {
-        Weight weight;
-        std::optional<EdgeId> prev_edge;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    size_t thread_count_;
+    size_t waiting_count_ = 0;
+    size_t generation_ = 0;
+};
+
+}  // namespace detail
+
+// Предрасчёт всех пар вершин (Флойд–Уоршелл). Матрицы весов и предыдущих рёбер
+// хранятся плоско (структура массивов) в одном буфере: недостижимость кодируется
+// бесконечным весом, отсутствие ребра — NO_EDGE. Матрицы можно сохранить в файл и в следующий раз
+// отобразить его в память вместо расчёта: файл подходит, только если совпал отпечаток графа
+template <typename Weight>
+class Router : public RouteEngine<Weight> {
+private:
+    using Graph = DirectedWeightedGraph<Weight>;
+
+public:
+    using RouteInfo = typename RouteEngine<Weight>::RouteInfo;
+
+    // Если cache_file задан, матрицы берутся из него, а при несовпадении пересчитываются и сохраняются туда
+    explicit Router(const Graph& graph, bool use_huge_pages = false, const std::string& cache_file = {});
+
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    using DistanceTable = typename RouteEngine<Weight>::DistanceTable;
+
+    // Веса читаются прямо из матрицы, пути не восстанавливаются
+    DistanceTable BuildDistanceTable(const std::vector<VertexId>& sources, const std::vector<VertexId>& targets) const override;
+
+    // Новое ребро или подешевевшее ребро (u, v) чинит матрицу за O(V^2): строки, которым путь через него
+    // выгоднее, получают d[x][u] + w + d[v][y]. Для подорожавшего ребра Дейкстрой пересчитываются только строки,
+    // в чьих деревьях оно было. Новые вершины расширяют матрицу. Отображённый файл сначала копируется в память
+    bool ApplyUpdates(const std::vector<EdgeUpdate<Weight>>& updates) override;
+
+    // Запись во временный файл и переименование, чтобы параллельный запуск не увидел недописанный файл
+    bool SaveToFile(const std::string& path) const;
+
+    bool IsLoadedFromFile() const {
+        return loaded_from_file_;
+    }
+
+private:
+    using PrevEdge = uint32_t;
+
+    struct FileHeader {
+        char magic[8];
+        uint64_t version;
+        uint64_t fingerprint;
+        uint64_t vertex_count;
+        uint64_t weight_size;
+        uint64_t data_size;
+        uint64_t reserved[2];
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+
+    static constexpr char FILE_MAGIC[8] = {'T', 'C', 'R', 'O', 'U', 'T', 'E', 'R'};
+    static constexpr uint64_t FILE_VERSION = 1;
+
+    static constexpr PrevEdge NO_EDGE = std::numeric_limits<PrevEdge>::max();
+    static constexpr size_t MIN_ROWS_PER_THREAD = 128;
+
+    static Weight GetInfinity() {
+        if constexpr (std::numeric_limits<Weight>::has_infinity) {
+            return std::numeric_limits<Weight>::infinity();
+        }
+        else {
+            return std::numeric_limits<Weight>::max();
+        }
+    }
+
+    // Для целых весов бесконечность — максимум типа, и сложение насыщается до неё вместо переполнения
+    static Weight AddWeights(Weight lhs, Weight rhs) {
+        if constexpr (std::is_integral_v<Weight>) {
+            return rhs >= GetInfinity() - lhs ? GetInfinity() : static_cast<Weight>(lhs + rhs);
+        }
+        else {
+            return lhs + rhs;
+        }
+    }
+
+    size_t GetWeightsSize() const {
+        return (vertex_count_ * vertex_count_ * sizeof(Weight) + alignof(std::max_align_t) - 1)
+               / alignof(std::max_align_t) * alignof(std::max_align_t);
+    }
+
+    size_t GetDataSize() const {
+        return GetWeightsSize() + vertex_count_ * vertex_count_ * sizeof(PrevEdge);
+    }
+
+    // FNV-1a по вершинам и рёбрам графа: граф определяется справочником и настройками маршрутов
+    uint64_t ComputeFingerprint() const {
+        uint64_t hash = 14695981039346656037ull;
+        const auto mix = [&hash](const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i) {
+                hash = (hash ^ bytes[i]) * 1099511628211ull;
+            }
+        };
+        const uint64_t sizes[] = {vertex_count_, graph_.GetEdgeCount()};
+        mix(sizes, sizeof(sizes));
+        for (EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph_.GetEdge(edge_id);
+            const uint64_t ends[] = {edge.from, edge.to};
+            mix(ends, sizeof(ends));
+            mix(&edge.weight, sizeof(Weight));
+        }
+        return hash;
+    }
+
+    FileHeader CreateFileHeader() const {
+        FileHeader header{};
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.version = FILE_VERSION;
+        header.fingerprint = ComputeFingerprint();
+        header.vertex_count = vertex_count_;
+        header.weight_size = sizeof(Weight);
+        header.data_size = GetDataSize();
+        return header;
+    }
+
+    // Матрицы указывают прямо в отображение файла, данные не копируются
+    bool LoadFromFile(const std::string& path) {
+        std::optional<detail::MatrixBuffer> file = detail::MatrixBuffer::MapFile(path);
+        if (!file || file->GetSize() != sizeof(FileHeader) + GetDataSize()) {
+            return false;
+        }
+        const FileHeader expected = CreateFileHeader();
+        if (std::memcmp(file->GetData(), &expected, sizeof(FileHeader)) != 0) {
+            return false;
+        }
+        buffer_ = std::move(*file);
+        char* data = static_cast<char*>(buffer_.GetData()) + sizeof(FileHeader);
+        weights_ = reinterpret_cast<Weight*>(data);
+        prev_edges_ = reinterpret_cast<PrevEdge*>(data + GetWeightsSize());
+        loaded_from_file_ = true;
+        return true;
+    }
+
+    void AllocateRoutesInternalData(bool use_huge_pages) {
+        const size_t cell_count = vertex_count_ * vertex_count_;
+        const size_t weights_size = GetWeightsSize();
+        buffer_ = detail::MatrixBuffer(GetDataSize(), use_huge_pages);
+        weights_ = static_cast<Weight*>(buffer_.GetData());
+        prev_edges_ = reinterpret_cast<PrevEdge*>(static_cast<char*>(buffer_.GetData()) + weights_size);
+        std::fill(weights_, weights_ + cell_count, GetInfinity());
+        std::fill(prev_edges_, prev_edges_ + cell_count, NO_EDGE);
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-            routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
-            for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
-                const auto& edge = graph.GetEdge(edge_id);
-                if (edge.weight < ZERO_WEIGHT) {
+        if (graph.GetEdgeCount() >= NO_EDGE) {
+            throw std::length_error("Too many edges for the route matrix");
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            Weight* weights = weights_ + vertex * vertex_count_;
+            PrevEdge* prev_edges = prev_edges_ + vertex * vertex_count_;
+            weights[vertex] = ZERO_WEIGHT;
+            graph.ForEachOutgoing(vertex, [weights, prev_edges](EdgeId edge_id, VertexId to, Weight weight) {
+                if (weight < ZERO_WEIGHT) {
                     throw std::domain_error("Edges' weights should be non-negative");
                 }
-                auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                    route_internal_data = RouteInternalData{edge.weight, edge_id};
+                if (weights[to] > weight) {
+                    weights[to] = weight;
+                    prev_edges[to] = static_cast<PrevEdge>(edge_id);
                 }
+            });
+        }
+    }
+
+    // Релаксация строки vertex_from через vertex_through. Строка и столбец vertex_through
+    // на этой фазе не меняются, поэтому строки независимы и порядок операций в каждой
+    // ячейке совпадает с последовательным алгоритмом
+    void RelaxRow(VertexId vertex_from, VertexId vertex_through) {
+        const Weight weight_from = weights_[vertex_from * vertex_count_ + vertex_through];
+        if (!(weight_from < GetInfinity())) {
+            return;
+        }
+        Weight* weights = weights_ + vertex_from * vertex_count_;
+        PrevEdge* prev_edges = prev_edges_ + vertex_from * vertex_count_;
+        const Weight* weights_through = weights_ + vertex_through * vertex_count_;
+        const PrevEdge* prev_edges_through = prev_edges_ + vertex_through * vertex_count_;
+
+        VertexId vertex_to = 0;
+        if constexpr (std::is_same_v<Weight, double>) {
+#if defined(__AVX2__)
+            const __m256d weight_from_x4 = _mm256_set1_pd(weight_from);
+            const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+            for (; vertex_to + 4 <= vertex_count_; vertex_to += 4) {
+                const __m256d candidate = _mm256_add_pd(weight_from_x4, _mm256_loadu_pd(weights_through + vertex_to));
+                const __m256d current = _mm256_loadu_pd(weights + vertex_to);
+                const __m256d mask = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+                _mm256_storeu_pd(weights + vertex_to, _mm256_blendv_pd(current, candidate, mask));
+                // Маска 4x64 ужимается до 4x32 под индексы рёбер
+                const __m128i mask_x32 = _mm256_castsi256_si128(
+                    _mm256_permutevar8x32_epi32(_mm256_castpd_si256(mask), low_halves));
+                const __m128i prev_current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges + vertex_to));
+                const __m128i prev_through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + vertex_to));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges + vertex_to),
+                                 _mm_blendv_epi8(prev_current, prev_through, mask_x32));
+            }
+#elif defined(__SSE2__) || defined(_M_X64)
+            const __m128d weight_from_x2 = _mm_set1_pd(weight_from);
+            for (; vertex_to + 2 <= vertex_count_; vertex_to += 2) {
+                const __m128d candidate = _mm_add_pd(weight_from_x2, _mm_loadu_pd(weights_through + vertex_to));
+                const __m128d current = _mm_loadu_pd(weights + vertex_to);
+                const __m128d mask = _mm_cmplt_pd(candidate, current);
+                _mm_storeu_pd(weights + vertex_to, _mm_or_pd(_mm_and_pd(mask, candidate), _mm_andnot_pd(mask, current)));
+                const __m128i mask_x32 = _mm_shuffle_epi32(_mm_castpd_si128(mask), _MM_SHUFFLE(2, 0, 2, 0));
+                const __m128i prev_current = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges + vertex_to));
+                const __m128i prev_through = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev_edges_through + vertex_to));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(prev_edges + vertex_to),
+                                 _mm_or_si128(_mm_and_si128(mask_x32, prev_through), _mm_andnot_si128(mask_x32, prev_current)));
+            }
+#endif
+        }
+        else if constexpr (std::is_same_v<Weight, uint32_t>) {
+            // Целые веса: 8 (4) ячеек за раз, индексы рёбер той же ширины. Перенос при сложении
+            // означает, что сумма меньше слагаемого, тогда ставятся все единицы — бесконечность
+#if defined(__AVX2__)
+            const __m256i weight_from_x8 = _mm256_set1_epi32(static_cast<int>(weight_from));
+            const __m256i all_ones = _mm256_set1_epi32(-1);
+            for (; vertex_to + 8 <= vertex_count_; vertex_to += 8) {
+                const __m256i through = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights_through + vertex_to));
+                const __m256i sum = _mm256_add_epi32(weight_from_x8, through);
+                const __m256i no_carry = _mm256_cmpeq_epi32(_mm256_max_epu32(sum, through), sum);
+                const __m256i candidate = _mm256_or_si256(sum, _mm256_xor_si256(no_carry, all_ones));
+                const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + vertex_to));
+                const __m256i best = _mm256_min_epu32(candidate, current);
+                const __m256i unchanged = _mm256_cmpeq_epi32(best, current);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(weights + vertex_to), best);
+                const __m256i prev_current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges + vertex_to));
+                const __m256i prev_through = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(prev_edges_through + vertex_to));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(prev_edges + vertex_to),
+                                    _mm256_blendv_epi8(prev_through, prev_current, unchanged));
+            }
+#elif defined(__SSE4_1__)
+            const __m128i weight_from_x4 = _mm_set1_epi32(static_cast<int>(weight_from));
+            const __m128i all_ones = _mm_set1_epi32(-1);
+            for (; vertex_to + 4 <= vertex_count_; vertex_to += 4) {
+                const __m128i through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights_through + vertex_to));
+                const __m128i sum = _mm_add_epi32(weight_from_x4, through);
+                const __m128i no_carry = _mm_cmpeq_epi32(_mm_max_epu32(sum, through), sum);
+                const __m128i candidate = _mm_or_si128(sum, _mm_xor_si128(no_carry, all_ones));
+                const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + vertex_to));
+                const __m128i best = _mm_min_epu32(candidate, current);
+                const __m128i unchanged = _mm_cmpeq_epi32(best, current);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(weights + vertex_to), best);
+                const __m128i prev_current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges + vertex_to));
+                const __m128i prev_through = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev_edges_through + vertex_to));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(prev_edges + vertex_to),
+                                 _mm_blendv_epi8(prev_through, prev_current, unchanged));
+            }
+#endif
+        }
+        for (; vertex_to < vertex_count_; ++vertex_to) {
+            const Weight candidate_weight = AddWeights(weight_from, weights_through[vertex_to]);
+            if (candidate_weight < weights[vertex_to]) {
+                weights[vertex_to] = candidate_weight;
+                prev_edges[vertex_to] = prev_edges_through[vertex_to];
             }
         }
     }
 
-    void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                    const RouteInternalData& route_to) {
-        auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-        const Weight candidate_weight = route_from.weight + route_to.weight;
-        if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-            route_relaxing = {candidate_weight,
-                              route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+    // Саму строку vertex_through не трогаем: диагональ нулевая, улучшить её нечем, а её перезапись
+    // векторным путём гонялась бы с потоками, читающими эту строку на той же фазе
+    void RelaxRoutesInternalDataThroughVertex(VertexId vertex_through, VertexId row_begin, VertexId row_end) {
+        for (VertexId vertex_from = row_begin; vertex_from < row_end; ++vertex_from) {
+            if (vertex_from != vertex_through) {
+                RelaxRow(vertex_from, vertex_through);
+            }
         }
     }
 
-    void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-        for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-            if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                    if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                        RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                    }
+    // Строки матрицы делятся на полосы по потокам, фазы разделены барьером
+    void RelaxRoutesInternalData() {
+        const size_t hardware_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        const size_t thread_count = std::clamp<size_t>(vertex_count_ / MIN_ROWS_PER_THREAD, 1, hardware_threads);
+        if (thread_count == 1) {
+            for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+                RelaxRoutesInternalDataThroughVertex(vertex_through, 0, vertex_count_);
+            }
+            return;
+        }
+
+        detail::PhaseBarrier barrier(thread_count);
+        const auto relax_stripe = [this, &barrier](VertexId row_begin, VertexId row_end) {
+            for (VertexId vertex_through = 0; vertex_through < vertex_count_; ++vertex_through) {
+                RelaxRoutesInternalDataThroughVertex(vertex_through, row_begin, row_end);
+                barrier.Wait();
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        const size_t stripe = (vertex_count_ + thread_count - 1) / thread_count;
+        for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+            const VertexId row_begin = std::min(vertex_count_, thread_index * stripe);
+            threads.emplace_back(relax_stripe, row_begin, std::min(vertex_count_, row_begin + stripe));
+        }
+        relax_stripe(0, std::min(vertex_count_, stripe));
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Переносит матрицы в новый записываемый буфер под vertex_count вершин, новые ячейки пусты
+    void Reallocate(size_t vertex_count) {
+        const detail::MatrixBuffer old_buffer = std::move(buffer_);
+        const Weight* old_weights = weights_;
+        const PrevEdge* old_prev_edges = prev_edges_;
+        const size_t old_vertex_count = vertex_count_;
+        vertex_count_ = vertex_count;
+        AllocateRoutesInternalData(use_huge_pages_);
+        for (VertexId vertex = 0; vertex < old_vertex_count; ++vertex) {
+            std::copy_n(old_weights + vertex * old_vertex_count, old_vertex_count, weights_ + vertex * vertex_count_);
+            std::copy_n(old_prev_edges + vertex * old_vertex_count, old_vertex_count, prev_edges_ + vertex * vertex_count_);
+        }
+        for (VertexId vertex = old_vertex_count; vertex < vertex_count_; ++vertex) {
+            weights_[vertex * vertex_count_ + vertex] = ZERO_WEIGHT;
+        }
+        loaded_from_file_ = false;
+    }
+
+    // Пути через ребро edge_id, если оно короче имеющихся. Проверяются только строки, где улучшается
+    // сама вершина edge.to, и только столбцы, достижимые из неё
+    void InsertEdge(EdgeId edge_id) {
+        const Edge<Weight>& edge = graph_.GetEdge(edge_id);
+        const Weight* weights_to = weights_ + edge.to * vertex_count_;
+        const PrevEdge* prev_edges_to = prev_edges_ + edge.to * vertex_count_;
+        reachable_.clear();
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            if (weights_to[vertex] < GetInfinity()) {
+                reachable_.push_back(vertex);
+            }
+        }
+        for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+            Weight* weights = weights_ + vertex_from * vertex_count_;
+            const Weight weight_from = AddWeights(weights[edge.from], edge.weight);
+            if (!(weights[edge.from] < GetInfinity()) || !(weight_from < weights[edge.to])) {
+                continue;
+            }
+            PrevEdge* prev_edges = prev_edges_ + vertex_from * vertex_count_;
+            for (const VertexId vertex_to : reachable_) {
+                const Weight candidate_weight = AddWeights(weight_from, weights_to[vertex_to]);
+                if (candidate_weight < weights[vertex_to]) {
+                    weights[vertex_to] = candidate_weight;
+                    prev_edges[vertex_to] = vertex_to == edge.to ? static_cast<PrevEdge>(edge_id) : prev_edges_to[vertex_to];
                 }
             }
         }
     }
 
+    // Строка vertex_from заново, Дейкстрой по текущему графу
+    void RecomputeRow(VertexId vertex_from) {
+        Weight* weights = weights_ + vertex_from * vertex_count_;
+        PrevEdge* prev_edges = prev_edges_ + vertex_from * vertex_count_;
+        std::fill(weights, weights + vertex_count_, GetInfinity());
+        std::fill(prev_edges, prev_edges + vertex_count_, NO_EDGE);
+        weights[vertex_from] = ZERO_WEIGHT;
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::vector<QueueItem> queue{{ZERO_WEIGHT, vertex_from}};
+        while (!queue.empty()) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+            const auto [weight, vertex] = queue.back();
+            queue.pop_back();
+            if (weights[vertex] < weight) {
+                continue;
+            }
+            graph_.ForEachOutgoing(vertex, [&](EdgeId edge_id, VertexId to, Weight edge_weight) {
+                if (AddWeights(weight, edge_weight) < weights[to]) {
+                    weights[to] = AddWeights(weight, edge_weight);
+                    prev_edges[to] = static_cast<PrevEdge>(edge_id);
+                    queue.push_back({weights[to], to});
+                    std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+                }
+            });
+        }
+    }
+
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
-    RoutesInternalData routes_internal_data_;
+    size_t vertex_count_ = 0;
+    bool use_huge_pages_ = false;
+    std::vector<VertexId> reachable_;
+    detail::MatrixBuffer buffer_;
+    Weight* weights_ = nullptr;
+    PrevEdge* prev_edges_ = nullptr;
+    bool loaded_from_file_ = false;
 };
 
 template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+Router<Weight>::Router(const Graph& graph, bool use_huge_pages, const std::string& cache_file)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , vertex_count_(graph.GetVertexCount())
+    , use_huge_pages_(use_huge_pages)
 {
+    if (!cache_file.empty() && LoadFromFile(cache_file)) {
+        return;
+    }
+    AllocateRoutesInternalData(use_huge_pages);
     InitializeRoutesInternalData(graph);
+    RelaxRoutesInternalData();
+    if (!cache_file.empty()) {
+        SaveToFile(cache_file);
+    }
+}
 
-    const size_t vertex_count = graph.GetVertexCount();
-    for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-        RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
+template <typename Weight>
+bool Router<Weight>::ApplyUpdates(const std::vector<EdgeUpdate<Weight>>& updates) {
+    if (graph_.GetEdgeCount() >= NO_EDGE) {
+        throw std::length_error("Too many edges for the route matrix");
+    }
+    if (loaded_from_file_ || graph_.GetVertexCount() != vertex_count_) {
+        Reallocate(graph_.GetVertexCount());
     }
+    // Строки, где подорожавшее ребро было последним до своего конца, считаются заново по новому графу.
+    // Остальные строки его не использовали и верны для графа без новых и подешевевших рёбер
+    std::vector<bool> stale_rows(vertex_count_, false);
+    for (const EdgeUpdate<Weight>& update : updates) {
+        const Edge<Weight>& edge = graph_.GetEdge(update.edge_id);
+        if (edge.weight < ZERO_WEIGHT) {
+            throw std::domain_error("Edges' weights should be non-negative");
+        }
+        if (!update.old_weight || !(*update.old_weight < edge.weight)) {
+            continue;
+        }
+        for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+            if (prev_edges_[vertex_from * vertex_count_ + edge.to] == update.edge_id) {
+                stale_rows[vertex_from] = true;
+            }
+        }
+    }
+    for (VertexId vertex_from = 0; vertex_from < vertex_count_; ++vertex_from) {
+        if (stale_rows[vertex_from]) {
+            RecomputeRow(vertex_from);
+        }
+    }
+    for (const EdgeUpdate<Weight>& update : updates) {
+        if (!update.old_weight || graph_.GetEdge(update.edge_id).weight < *update.old_weight) {
+            InsertEdge(update.edge_id);
+        }
+    }
+    return true;
+}
+
+template <typename Weight>
+bool Router<Weight>::SaveToFile(const std::string& path) const {
+    const std::string temp_path = path + ".tmp";
+    {
+        std::ofstream output(temp_path, std::ios::binary | std::ios::trunc);
+        const FileHeader header = CreateFileHeader();
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        const char* data = reinterpret_cast<const char*>(weights_);
+        output.write(data, static_cast<std::streamsize>(GetDataSize()));
+        if (!output) {
+            output.close();
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    return std::rename(temp_path.c_str(), path.c_str()) == 0;
 }
 
 template <typename Weight>
 std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                              VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-    if (!route_internal_data) {
+    if (from >= vertex_count_ || to >= vertex_count_) {
+        throw std::out_of_range("Vertex id is out of range");
+    }
+    const Weight* weights = weights_ + from * vertex_count_;
+    const PrevEdge* prev_edges = prev_edges_ + from * vertex_count_;
+    if (!(weights[to] < GetInfinity())) {
         return std::nullopt;
     }
-    const Weight weight = route_internal_data->weight;
     std::vector<EdgeId> edges;
-    for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-         edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
-    {
-        edges.push_back(*edge_id);
+    for (PrevEdge edge_id = prev_edges[to]; edge_id != NO_EDGE; edge_id = prev_edges[graph_.GetEdge(edge_id).from]) {
+        edges.push_back(edge_id);
     }
     std::reverse(edges.begin(), edges.end());
 
-    return RouteInfo{weight, std::move(edges)};
+    return RouteInfo{weights[to], std::move(edges)};
+}
+
+template <typename Weight>
+typename Router<Weight>::DistanceTable Router<Weight>::BuildDistanceTable(const std::vector<VertexId>& sources,
+                                                                          const std::vector<VertexId>& targets) const {
+    DistanceTable table;
+    table.reserve(sources.size());
+    for (const VertexId from : sources) {
+        if (from >= vertex_count_) {
+            throw std::out_of_range("Vertex id is out of range");
+        }
+        const Weight* weights = weights_ + from * vertex_count_;
+        std::vector<std::optional<Weight>>& row = table.emplace_back();
+        row.reserve(targets.size());
+        for (const VertexId to : targets) {
+            if (to >= vertex_count_) {
+                throw std::out_of_range("Vertex id is out of range");
+            }
+            row.push_back(weights[to] < GetInfinity() ? std::optional<Weight>(weights[to]) : std::nullopt);
+        }
+    }
+    return table;
 }
 
 }  // namespace graph
\ No newline at end of file
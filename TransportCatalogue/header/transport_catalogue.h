@@ -1,71 +1,126 @@
 #pragma once
 
-#include <unordered_map>
-#include <unordered_set>
+#include <cmath>
+#include <cstdint>
+#include <string>
 #include <string_view>
 #include <deque>
+#include <memory>
 #include <set>
 #include <optional>
+#include <vector>
 
 #include "domain.h"
+#include "flat_hash_map.h"
 
 namespace transport_catalogue {
 	namespace store {
 		using namespace domain;
 		using namespace geo;
-		namespace detail {
-			struct DistanceHasher {
-				size_t operator()(const std::pair<const Stop*, const Stop*>& dist) const {
-					return std::hash<const void*>{}(dist.first) + std::hash<const void*>{}(dist.second);
-				}
-			};
-		}
+		class CatalogueSnapshot;
+
 		class TransportCatalogue {
 		public:
-			void AddBus(const std::string& name, std::vector<Stop*> bus_route, bool is_roundtrip);
+			void AddBus(const std::string& name, std::vector<uint32_t> bus_route, bool is_roundtrip);
 
 			void AddStop(std::string stop_name, geo::Coordinates coordinates);
 
+			// Строит совершенные хэши по всем именам и параллельно считает BusRouteInfo автобусов, для которых
+			// их ещё нет. Имена, добавленные после этого, ищутся в обычной хэш-таблице, сведения о новых
+			// автобусах считаются сразу в AddBus
+			void Finalize();
+
+			// Неизменяемый снимок текущего состояния. Дальнейшие изменения каталога в снимок не попадают,
+			// для них нужен новый снимок. Совершенные хэши снимок разделяет с каталогом; Finalize
+			// вызывается, только если их ещё нет или вне их больше 1/8 имён. Массивы снимка (имена,
+			// маршруты, автобусы по остановкам) копируются всегда, так что каждый вызов линеен по размеру
+			// каталога, в том числе после единственного AddBus или SetDistance
+			std::shared_ptr<const CatalogueSnapshot> Freeze();
+
 			const Bus* FindBus(std::string_view name_bus) const;
 
 			const Stop* FindStop(std::string_view name_stop) const;
 
+			// Доступ по порядковому номеру (Stop::id, Bus::id)
+			const Stop* GetStop(size_t id) const;
+
+			const Bus* GetBus(size_t id) const;
+
 			void SetDistance(const std::string& first_stop_name, const std::string& second_stop_name, const double& distance);
 
-			const std::unordered_map <std::string_view, Stop*>& GetAllStops() const;
+			// Все остановки и автобусы в порядке id
+			const std::vector<Stop>& GetStops() const;
 
-			const std::unordered_map <std::string_view, Bus*>& GetAllBuses() const;
+			const std::vector<Bus>& GetBuses() const;
 
 			const std::optional<BusRouteInfo> GetInfoRoute(std::string_view name_bus) const;
 
 			const std::set<std::string_view>* GetInfoStop(std::string_view stop) const;
 
-			const std::optional<double> GetLenght(const Stop* first_stop, const Stop* second_stop) const;
+			// id автобусов, проходящих через остановку, по возрастанию
+			const std::vector<uint32_t>& GetStopBuses(uint32_t stop_id) const;
+
+			const std::optional<double> GetLenght(uint32_t first_stop, uint32_t second_stop) const;
+
+			// Совершенные хэши имён из последнего Finalize, nullptr до него
+			std::shared_ptr<const detail::PerfectHashIndex> GetStopIndex() const;
+
+			std::shared_ptr<const detail::PerfectHashIndex> GetBusIndex() const;
 
 		private:
-			std::deque<Bus> deq_buses_;
-			std::deque<Stop> deq_stops_;
-			std::unordered_map<std::string_view, Stop*> all_stops_;
-			std::unordered_map<std::string_view, Bus*> all_buses_;
-			std::unordered_map<std::pair<const Stop*, const Stop*>, double, detail::DistanceHasher> distance_;
-			std::unordered_map<std::string_view, std::set<std::string_view>> stop_buses_;
+			// Расстояние до соседней остановки. Заданное явно (from -> stop_id) важнее обратного (stop_id -> from),
+			// которое используется, пока прямого нет
+			struct Distance {
+				uint32_t stop_id = 0;
+				bool is_forward = false;
+				double lenght = 0.0;
+			};
+
+			// Запись о соседе в массиве остановки, отсортированном по id соседа; вставляет её при отсутствии
+			Distance& GetDistanceEntry(uint32_t first_stop, uint32_t second_stop);
+
+			void ComputeSegmentLenghts(Bus& bus) const;
+
+			BusRouteInfo ComputeRouteInfo(const Bus* bus) const;
+
+			void ComputeRouteInfos();
 
-			template <typename Begin, typename End>
-			std::pair<double, double> GetAllLenght(const Begin begin, const End end) const;
+			const std::string& StoreName(std::string name);
+
+			std::optional<uint32_t> FindStopId(std::string_view name_stop) const;
+
+			std::optional<uint32_t> FindBusId(std::string_view name_bus) const;
+
+			std::deque<std::string> names_;	// адреса строк не меняются, на них ссылаются Stop::name и Bus::name
+			std::vector<Bus> buses_;
+			std::vector<Stop> stops_;
+			detail::FlatHashMap<std::string_view, uint32_t> stop_ids_;
+			detail::FlatHashMap<std::string_view, uint32_t> bus_ids_;
+			std::shared_ptr<const detail::PerfectHashIndex> stop_index_;
+			std::shared_ptr<const detail::PerfectHashIndex> bus_index_;
+			std::vector<std::vector<Distance>> distances_;	// по id остановки
+			std::vector<BusRouteInfo> route_infos_;	// по id автобуса, до Finalize пуст
+			std::vector<std::set<std::string_view>> stop_bus_names_;
+			std::vector<std::vector<uint32_t>> stop_buses_;
+
+			template <typename Begin, typename End, typename Lenght>
+			std::pair<double, double> GetAllLenght(const Begin begin, const End end, Lenght lenght_it) const;
 
 			size_t GetUniqueStops(const Bus* bus) const;
+
+			static constexpr size_t MIN_BUSES_PER_THREAD = 256;
+			static constexpr size_t UNINDEXED_NAMES_FRACTION = 8;	// Freeze перестраивает хэши, если вне них больше 1/8 имён
 		};
 
-		template <typename Begin, typename End>
-		inline std::pair<double, double> TransportCatalogue::GetAllLenght(const Begin begin, const End end) const {
+		template <typename Begin, typename End, typename Lenght>
+		inline std::pair<double, double> TransportCatalogue::GetAllLenght(const Begin begin, const End end, Lenght lenght_it) const {
 			double lenght = 0.0;
 			double curvature = 0.0;
-			for (auto stop1 = begin, stop2 = stop1 + 1; stop2 != end; ++stop1, ++stop2) {
-				std::optional<double> lenght_ = GetLenght(*stop1, *stop2);
-				if (lenght_ != std::nullopt) {
-					lenght += *lenght_;
+			for (auto stop1 = begin, stop2 = stop1 + 1; stop2 != end; ++stop1, ++stop2, ++lenght_it) {
+				if (!std::isnan(*lenght_it)) {
+					lenght += *lenght_it;
 				}
-				curvature += ComputeDistance((*stop1)->coordinates, (*stop2)->coordinates);
+				curvature += ComputeDistance(stops_[*stop1].coordinates, stops_[*stop2].coordinates);
 			}
 			return { lenght, curvature };
 		}
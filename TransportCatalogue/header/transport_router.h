@@ -1,22 +1,62 @@
 #pragma once
 
-#include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
 #include "router.h"
+#include "dijkstra_router.h"
+#include "contraction_hierarchy.h"
+#include "a_star_router.h"
+#include "fixed_point_router.h"
+#include "k_shortest_paths.h"
+#include "path_tree_cache.h"
+#include <cstdint>
 #include <memory>
 
 namespace route {
 	using namespace transport_catalogue::store;
 	using namespace std::literals;
 
+	enum class RouterEngine {
+		FLOYD_WARSHALL,	// предрасчёт всех пар при создании
+		DIJKSTRA,		// поиск по запросу без предрасчёта
+		BIDIRECTIONAL_DIJKSTRA,	// встречный поиск из начала и из конца по запросу
+		CONTRACTION_HIERARCHIES,	// иерархия сжатий, двунаправленный поиск по запросу
+		A_STAR,		// поиск по запросу с оценкой времени по расстоянию по прямой до цели
+		RAPTOR,		// поиск по раундам прямо по маршрутам автобусов, граф не строится
+	};
+
+	enum class GraphModel {
+		COMPLETE,	// ребро от каждой остановки до каждой следующей на маршруте
+		LINEAR,		// вершины ожидания на остановках и вершины поездки на маршрутах, O(длины маршрута) рёбер
+	};
+
 	struct RouteSettings {
 		int bus_wait_time = 0;
 		int bus_velocity = 0;
+		RouterEngine engine = RouterEngine::FLOYD_WARSHALL;
+		GraphModel graph_model = GraphModel::COMPLETE;
+		bool use_huge_pages = false;	// матрица Флойда–Уоршелла на huge pages (Linux)
+		size_t tree_cache_size = 64 * 1024 * 1024;	// бюджет кэша деревьев путей для Дейкстры, байт; 0 — без кэша
+		std::string cache_file;	// файл с матрицами Флойда–Уоршелла между запусками; пусто — не сохранять
+		bool use_integer_weights = false;	// Флойд–Уоршелл на целых весах в десятых долях секунды
 	};
 
-	struct EdgeData {
-		double time_weight = 0.0;
-		int span_count = 0;
-		std::string_view bus_name = {};
+	enum class EdgeType : uint8_t {
+		BUS,		// ожидание и поездка через span_count остановок (полная модель)
+		WAIT,		// посадка: остановка -> вершина поездки, вес — ожидание автобуса
+		RIDE,		// перегон между соседними вершинами поездки
+		TRANSFER,	// высадка: вершина поездки -> остановка, нулевой вес
+	};
+
+	// Метаданные рёбер графа по EdgeId, структура массивов: номера остановок и автобусов,
+	// имена берутся из справочника только при построении ответа. Время ребра — его вес в графе
+	struct EdgesInfo {
+		std::vector<uint32_t> from_stops;
+		std::vector<uint32_t> to_stops;
+		std::vector<uint32_t> buses;
+		std::vector<uint16_t> span_counts;
+		std::vector<EdgeType> types;
+
+		void Add(size_t from_stop, size_t to_stop, size_t bus, size_t span_count, EdgeType type);
 	};
 
 	struct RouteData {
@@ -28,29 +68,137 @@ namespace route {
 		int span_count = 0;
 	};
 
+	// Остановка, достижимая в пределах бюджета времени, и время в пути до неё в минутах
+	struct ReachableStop {
+		std::string_view stop_name = {};
+		double time = 0.0;
+	};
+
+	class RaptorRouter;
+
 	class TransportRouter {
 	public:
 		using Graph = graph::DirectedWeightedGraph<double>;
+		using RouteInfo = graph::RouteEngine<double>::RouteInfo;
+		using TimeMatrix = std::vector<std::vector<std::optional<double>>>;
+
+		// Маршрутизатор читает только снимок справочника и держит его, пока не получит новый
+		TransportRouter(std::shared_ptr<const CatalogueSnapshot> catalogue, const RouteSettings& route_setting);
 
-		using EdgesList = std::vector<std::pair<std::string_view, std::string_view>>;
-		using EdgesInfo = std::vector<EdgeData>;
+		~TransportRouter();
 
-		TransportRouter(const TransportCatalogue& catalogue, const RouteSettings& route_setting);
+		bool IsInitialized() const;
 
 		std::optional<std::vector<RouteData>> CreatRoute(const std::string_view& from, const std::string_view& to) const;
 
+		// Маршруты из одной остановки в несколько за один поиск, ответы в порядке to_list
+		std::vector<std::optional<std::vector<RouteData>>> CreatRoutes(const std::string_view& from,
+			const std::vector<std::string_view>& to_list) const;
+
+		// Недоминируемые по (времени, пересадкам) маршруты, по возрастанию числа пересадок; считаются RAPTOR
+		// при любом движке. Пустой вектор, если маршрута нет
+		std::vector<std::vector<RouteData>> CreatParetoRoutes(const std::string_view& from, const std::string_view& to) const;
+
+		// Быстрейший маршрут и до alternatives_count альтернатив без повторных остановок (Йен), по возрастанию времени.
+		// Варианты с высадкой и посадкой в тот же автобус, который довёз бы без высадки не дольше,
+		// отбрасываются. Пустой вектор, если маршрута нет
+		std::vector<std::vector<RouteData>> CreatAlternativeRoutes(const std::string_view& from, const std::string_view& to,
+			size_t alternatives_count) const;
+
+		// Времена в пути в минутах для всех пар from_list × to_list; nullopt, если какой-то остановки нет.
+		// Флойд–Уоршелл читает свою матрицу, иерархия сжатий считает корзинами, остальные движки строят
+		// по дереву кратчайших путей на строку (из кэша деревьев, если он включён)
+		std::optional<TimeMatrix> CreatTimeMatrix(const std::vector<std::string_view>& from_list,
+			const std::vector<std::string_view>& to_list) const;
+
+		// Все остановки, до которых из from не дольше max_time минут, по возрастанию времени;
+		// nullopt, если остановки нет. Поиск из одной вершины, обрывается на бюджете
+		std::optional<std::vector<ReachableStop>> CreatIsochrone(const std::string_view& from, double max_time) const;
+
+		const graph::ShortestPathTreeCache<double>& GetTreeCache() const;
+
+		// Обновления после изменения справочника без полного перестроения: рёбра добавляются в граф или меняют вес,
+		// движок чинит предрасчёт (см. graph::RouteEngine::ApplyUpdates), из кэша уходят только затронутые деревья.
+		// Новая остановка в справочнике сбрасывает всё до перестроения при следующем запросе.
+		// catalogue — новый снимок того же справочника (TransportCatalogue::Freeze), он заменяет прежний.
+		// Снимок вызывающий строит сам, и это линейное копирование всего справочника: на 400 остановках
+		// Freeze занимает 0.2–0.5 мс, столько же или больше, чем само обновление Дейкстры. Флойду–Уоршеллу
+		// обновление обходится дороже (там же 0.2–6 мс на полной модели, до 1.5 с на линейной), и Freeze на его фоне мал
+		void AddBus(std::shared_ptr<const CatalogueSnapshot> catalogue, std::string_view bus_name);
+
+		// Расстояние между остановками изменилось: пересчитываются веса рёбер автобусов, проходящих через from
+		void UpdateDistance(std::shared_ptr<const CatalogueSnapshot> catalogue, std::string_view from, std::string_view to);
+
 	private:
-		const TransportCatalogue& catalogue_;
+		// Рёбра автобуса лежат в графе подряд
+		struct BusEdges {
+			graph::EdgeId begin = 0;
+			graph::EdgeId end = 0;
+			graph::VertexId first_ride_vertex = 0;
+		};
+
+		std::shared_ptr<const CatalogueSnapshot> catalogue_;
 		const RouteSettings& route_setting_;
 		mutable Graph graph_;
-		std::unique_ptr<graph::Router<double>> router_ = nullptr;
+		mutable std::unique_ptr<graph::RouteEngine<double>> router_ = nullptr;
+		// Дейкстра с кэшем деревьев: повторный запрос из той же остановки — только восстановление пути
+		mutable const graph::DijkstraRouter<double>* tree_router_ = nullptr;
+		mutable graph::ShortestPathTreeCache<double> tree_cache_;
+		mutable std::unique_ptr<RaptorRouter> raptor_;
+		// Деревья для изохрон и матрицы времён, когда основной движок — не Дейкстра
+		mutable std::unique_ptr<graph::DijkstraRouter<double>> reach_router_ = nullptr;
+		// Альтернативные маршруты ищутся по графу при любом движке
+		mutable std::unique_ptr<graph::KShortestPaths<double>> alternatives_router_ = nullptr;
 
-		mutable EdgesList edges_;
 		mutable EdgesInfo edges_info_;
+		mutable std::vector<BusEdges> bus_edges_;	// по Bus::id
+
+		mutable size_t stop_count_ = 0;	// остановок в справочнике на момент построения графа
+		mutable graph::VertexId next_ride_vertex_ = 0;
+
+		// Для A*: координаты вершин графа и минимальное время на метр по прямой среди всех рёбер
+		mutable std::vector<geo::Coordinates> vertex_coordinates_;
+		mutable double time_per_meter_ = 0.0;
+
+		size_t CountVertices() const;
+
+		size_t CountRideVertices(const BusView& bus) const;
+
+		// Граф и движок поиска строятся при первом запросе маршрута
+		void Initialize() const;
+
+		// Граф без движка; для RAPTOR он нужен только альтернативным маршрутам
+		void PrepareGraph() const;
 
 		void BuildGraph() const;
 
-		std::vector<RouteData> CreateAnswer(const std::optional<graph::Router<double>::RouteInfo>& route_info) const;
+		void AddBusEdges(const BusView& bus) const;
+
+		// Сбрасывает граф и движки, следующий запрос построит их заново
+		void Reset();
+
+		void ApplyUpdates(const std::vector<graph::EdgeUpdate<double>>& updates);
+
+		std::unique_ptr<graph::RouteEngine<double>> CreateEngine() const;
+
+		const RaptorRouter& GetRaptorRouter() const;
+
+		// Основной движок, если это Дейкстра, иначе reach_router_
+		const graph::DijkstraRouter<double>& GetDijkstraRouter() const;
+
+		bool FindStopIds(const std::vector<std::string_view>& names, std::vector<graph::VertexId>& ids) const;
+
+		void PrepareLowerBound() const;
+
+		double GetLowerBound(graph::VertexId vertex, graph::VertexId to) const;
+
+		std::optional<RouteInfo> BuildRoute(graph::VertexId from, graph::VertexId to) const;
+
+		std::vector<std::optional<RouteInfo>> BuildRoutes(graph::VertexId from, const std::vector<graph::VertexId>& targets) const;
+
+		std::optional<std::vector<RouteData>> CreateRouteData(const std::optional<RouteInfo>& route_info) const;
+
+		std::vector<RouteData> CreateAnswer(const std::optional<RouteInfo>& route_info) const;
 
 		RouteData CreateBusAnswer(size_t edge_index, double time) const;
 
@@ -58,30 +206,74 @@ namespace route {
 
 		RouteData CreateEmptyAnswer() const;
 
-		template <typename Begin, typename End>
-		void CreateEdgesAlongRoute(const Begin begin, const End end, std::string_view bus_name) const;
+		// Рёбра автобуса в порядке добавления в граф: add_edge(edge, from_stop, to_stop, span_count, type).
+		// Вершины поездки нумеруются с first_ride_vertex; возвращает их число
+		template <typename AddEdge>
+		size_t ForEachBusEdge(const BusView& bus, graph::VertexId first_ride_vertex, AddEdge add_edge) const;
+
+		// lenghts — длины перегонов в порядке обхода [begin, end) (Bus::lenghts или Bus::back_lenghts)
+		template <typename Begin, typename End, typename AddEdge>
+		void CreateEdgesAlongRoute(const Begin begin, const End end, ranges::Range<const double*> lenghts, AddEdge& add_edge) const;
+
+		template <typename Begin, typename End, typename AddEdge>
+		void CreateLinearEdgesAlongRoute(const Begin begin, const End end, ranges::Range<const double*> lenghts,
+			graph::VertexId first_ride_vertex, AddEdge& add_edge) const;
 
 	};
 
-	template <typename Begin, typename End>
-	void TransportRouter::CreateEdgesAlongRoute(const Begin begin, const End end, std::string_view bus_name) const {
+	template <typename AddEdge>
+	size_t TransportRouter::ForEachBusEdge(const BusView& bus, graph::VertexId first_ride_vertex, AddEdge add_edge) const {
+		const ranges::Range<const uint32_t*> bus_route = bus.bus_route;
+		if (route_setting_.graph_model == GraphModel::LINEAR) {
+			CreateLinearEdgesAlongRoute(bus_route.begin(), bus_route.end(), bus.lenghts, first_ride_vertex, add_edge);
+			if (!bus.is_roundtrip) {
+				CreateLinearEdgesAlongRoute(bus_route.rbegin(), bus_route.rend(), bus.back_lenghts, first_ride_vertex + bus_route.size(), add_edge);
+			}
+			return CountRideVertices(bus);
+		}
+		CreateEdgesAlongRoute(bus_route.begin(), bus_route.end(), bus.lenghts, add_edge);
+		if (!bus.is_roundtrip) {
+			CreateEdgesAlongRoute(bus_route.rbegin(), bus_route.rend(), bus.back_lenghts, add_edge);
+		}
+		return 0;
+	}
+
+	template <typename Begin, typename End, typename AddEdge>
+	void TransportRouter::CreateEdgesAlongRoute(const Begin begin, const End end, ranges::Range<const double*> lenghts,
+		AddEdge& add_edge) const {
 		const double wait = route_setting_.bus_wait_time * 60 * 1.0;
 		const double bus_speed = route_setting_.bus_velocity * 1.0 / 3.6;
 
 		for (auto it_stop = begin; it_stop < end; ++it_stop) {
 			int span_count = 1;
 			double current_lenght = 0.0;
-			for (auto from_stop = it_stop, to_stop = from_stop + 1; to_stop != end; ++from_stop, ++to_stop) {
-				std::optional<double> lenght = catalogue_.GetLenght(*from_stop, *to_stop);
-				current_lenght += lenght.value();
+			for (auto to_stop = it_stop + 1; to_stop != end; ++to_stop) {
+				current_lenght += GetSegmentLenght(lenghts, static_cast<size_t>(to_stop - begin) - 1);
 				double time_weight = current_lenght / bus_speed + wait;
 
-				graph_.AddEdge({ (*it_stop)->id, (*to_stop)->id, time_weight });
-
-				edges_.push_back({ (*it_stop)->name, (*to_stop)->name });
-				edges_info_.push_back({ time_weight, span_count, bus_name });
+				add_edge({ *it_stop, *to_stop, time_weight }, *it_stop, *to_stop, span_count, EdgeType::BUS);
 				++span_count;
 			}
 		}
 	}
+
+	template <typename Begin, typename End, typename AddEdge>
+	void TransportRouter::CreateLinearEdgesAlongRoute(const Begin begin, const End end, ranges::Range<const double*> lenghts,
+		graph::VertexId first_ride_vertex, AddEdge& add_edge) const {
+		const double wait = route_setting_.bus_wait_time * 60 * 1.0;
+		const double bus_speed = route_setting_.bus_velocity * 1.0 / 3.6;
+
+		for (auto it_stop = begin; it_stop != end; ++it_stop) {
+			const graph::VertexId ride_vertex = first_ride_vertex + static_cast<size_t>(it_stop - begin);
+			const graph::VertexId stop_vertex = *it_stop;
+			if (it_stop != begin) {
+				const double time_weight = GetSegmentLenght(lenghts, static_cast<size_t>(it_stop - begin) - 1) / bus_speed;
+				add_edge({ ride_vertex - 1, ride_vertex, time_weight }, *(it_stop - 1), stop_vertex, 1, EdgeType::RIDE);
+				add_edge({ ride_vertex, stop_vertex, 0.0 }, stop_vertex, stop_vertex, 0, EdgeType::TRANSFER);
+			}
+			if (it_stop + 1 != end) {
+				add_edge({ stop_vertex, ride_vertex, wait }, stop_vertex, stop_vertex, 0, EdgeType::WAIT);
+			}
+		}
+	}
 }
\ No newline at end of file
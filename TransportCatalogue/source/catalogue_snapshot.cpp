@@ -0,0 +1,169 @@
+#include "catalogue_snapshot.h"
+#include "transport_catalogue.h"
+
+namespace transport_catalogue {
+	namespace store {
+		CatalogueSnapshot::CatalogueSnapshot(const TransportCatalogue& catalogue)
+			: stop_index_(catalogue.GetStopIndex())
+			, bus_index_(catalogue.GetBusIndex()) {
+			const std::vector<Stop>& stops = catalogue.GetStops();
+			const std::vector<Bus>& buses = catalogue.GetBuses();
+
+			// Сначала все массивы заполняются целиком, потом на них ставятся представления:
+			// до этого они ещё могут переехать при росте
+			size_t names_size = 0;
+			size_t route_size = 0;
+			size_t lenghts_size = 0;
+			for (const Stop& stop : stops) {
+				names_size += stop.name.size();
+			}
+			for (const Bus& bus : buses) {
+				names_size += bus.name.size();
+				route_size += bus.bus_route.size();
+				lenghts_size += bus.lenghts.size() + bus.back_lenghts.size();
+			}
+			names_.reserve(names_size);
+			route_stops_.reserve(route_size);
+			route_lenghts_.reserve(lenghts_size);
+			for (const Stop& stop : stops) {
+				names_ += stop.name;
+			}
+			for (const Bus& bus : buses) {
+				names_ += bus.name;
+				route_stops_.insert(route_stops_.end(), bus.bus_route.begin(), bus.bus_route.end());
+				route_lenghts_.insert(route_lenghts_.end(), bus.lenghts.begin(), bus.lenghts.end());
+				route_lenghts_.insert(route_lenghts_.end(), bus.back_lenghts.begin(), bus.back_lenghts.end());
+			}
+
+			// Имена вне общего индекса (добавленные после Finalize) ищутся в своих таблицах
+			const size_t indexed_stops = stop_index_ != nullptr ? stop_index_->GetSize() : 0;
+			const size_t indexed_buses = bus_index_ != nullptr ? bus_index_->GetSize() : 0;
+			unindexed_stop_ids_.Reserve(stops.size() - indexed_stops);
+			unindexed_bus_ids_.Reserve(buses.size() - indexed_buses);
+
+			size_t name_offset = 0;
+			stops_.reserve(stops.size());
+			for (const Stop& stop : stops) {
+				stops_.push_back({ std::string_view(names_).substr(name_offset, stop.name.size()), stop.coordinates, stop.id });
+				name_offset += stop.name.size();
+				if (stop.id >= indexed_stops) {
+					unindexed_stop_ids_.Insert(stops_.back().name, stop.id);
+				}
+			}
+
+			size_t route_offset = 0;
+			size_t lenghts_offset = 0;
+			buses_.reserve(buses.size());
+			route_infos_.reserve(buses.size());
+			for (const Bus& bus : buses) {
+				BusView view;
+				view.name = std::string_view(names_).substr(name_offset, bus.name.size());
+				name_offset += bus.name.size();
+				const uint32_t* route = route_stops_.data() + route_offset;
+				view.bus_route = { route, route + bus.bus_route.size() };
+				route_offset += bus.bus_route.size();
+				const double* lenghts = route_lenghts_.data() + lenghts_offset;
+				view.lenghts = { lenghts, lenghts + bus.lenghts.size() };
+				view.back_lenghts = { view.lenghts.end(), view.lenghts.end() + bus.back_lenghts.size() };
+				lenghts_offset += bus.lenghts.size() + bus.back_lenghts.size();
+				view.is_roundtrip = bus.is_roundtrip;
+				view.id = bus.id;
+				buses_.push_back(view);
+				route_infos_.push_back(*catalogue.GetInfoRoute(bus.name));
+				if (bus.id >= indexed_buses) {
+					unindexed_bus_ids_.Insert(view.name, bus.id);
+				}
+			}
+
+			// Списки автобусов по остановкам: по id для маршрутизатора и по имени для ответов
+			stop_bus_offsets_.reserve(stops.size() + 1);
+			stop_bus_offsets_.push_back(0);
+			for (const Stop& stop : stops) {
+				const std::vector<uint32_t>& stop_buses = catalogue.GetStopBuses(stop.id);
+				stop_buses_.insert(stop_buses_.end(), stop_buses.begin(), stop_buses.end());
+				for (const std::string_view bus_name : *catalogue.GetInfoStop(stop.name)) {
+					stop_bus_names_.push_back(buses_[FindBus(bus_name)->id].name);
+				}
+				stop_bus_offsets_.push_back(static_cast<uint32_t>(stop_buses_.size()));
+			}
+		}
+
+		std::optional<uint32_t> CatalogueSnapshot::FindStopId(std::string_view name_stop) const {
+			if (stop_index_ != nullptr) {
+				const std::optional<uint32_t> id = stop_index_->Find(name_stop, [this](uint32_t id) {
+					return stops_[id].name;
+				});
+				if (id || unindexed_stop_ids_.GetSize() == 0) {
+					return id;
+				}
+			}
+			const uint32_t* id = unindexed_stop_ids_.Find(name_stop);
+			return id != nullptr ? std::optional<uint32_t>(*id) : std::nullopt;
+		}
+
+		std::optional<uint32_t> CatalogueSnapshot::FindBusId(std::string_view name_bus) const {
+			if (bus_index_ != nullptr) {
+				const std::optional<uint32_t> id = bus_index_->Find(name_bus, [this](uint32_t id) {
+					return buses_[id].name;
+				});
+				if (id || unindexed_bus_ids_.GetSize() == 0) {
+					return id;
+				}
+			}
+			const uint32_t* id = unindexed_bus_ids_.Find(name_bus);
+			return id != nullptr ? std::optional<uint32_t>(*id) : std::nullopt;
+		}
+
+		const BusView* CatalogueSnapshot::FindBus(std::string_view name_bus) const {
+			const std::optional<uint32_t> id = FindBusId(name_bus);
+			return (id ? &buses_[*id] : nullptr);
+		}
+
+		const Stop* CatalogueSnapshot::FindStop(std::string_view name_stop) const {
+			const std::optional<uint32_t> id = FindStopId(name_stop);
+			return (id ? &stops_[*id] : nullptr);
+		}
+
+		const Stop* CatalogueSnapshot::GetStop(size_t id) const {
+			return &stops_.at(id);
+		}
+
+		const BusView* CatalogueSnapshot::GetBus(size_t id) const {
+			return &buses_.at(id);
+		}
+
+		const std::vector<Stop>& CatalogueSnapshot::GetStops() const {
+			return stops_;
+		}
+
+		const std::vector<BusView>& CatalogueSnapshot::GetBuses() const {
+			return buses_;
+		}
+
+		std::optional<BusRouteInfo> CatalogueSnapshot::GetInfoRoute(std::string_view name_bus) const {
+			const std::optional<uint32_t> id = FindBusId(name_bus);
+			if (!id) {
+				return std::nullopt;
+			}
+			return route_infos_[*id];
+		}
+
+		std::optional<ranges::Range<const std::string_view*>> CatalogueSnapshot::GetInfoStop(std::string_view stop) const {
+			const std::optional<uint32_t> id = FindStopId(stop);
+			if (!id) {
+				return std::nullopt;
+			}
+			return GetStopBusNames(*id);
+		}
+
+		ranges::Range<const std::string_view*> CatalogueSnapshot::GetStopBusNames(uint32_t stop_id) const {
+			const std::string_view* names = stop_bus_names_.data();
+			return { names + stop_bus_offsets_.at(stop_id), names + stop_bus_offsets_.at(stop_id + 1) };
+		}
+
+		ranges::Range<const uint32_t*> CatalogueSnapshot::GetStopBuses(uint32_t stop_id) const {
+			const uint32_t* buses = stop_buses_.data();
+			return { buses + stop_bus_offsets_.at(stop_id), buses + stop_bus_offsets_.at(stop_id + 1) };
+		}
+	}
+}
@@ -1 +1,13 @@
 #include "domain.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace domain {
+	double GetSegmentLenght(ranges::Range<const double*> lenghts, size_t index) {
+		if (std::isnan(lenghts[index])) {
+			throw std::invalid_argument("Distance between stops is not set");
+		}
+		return lenghts[index];
+	}
+}
@@ -431,6 +431,12 @@ namespace json {
         output << "]";
     }
 
+    void PrintObj(ostream& output, const RawJson& raw) {
+        if (raw.text != nullptr) {
+            output.write(raw.text->data(), static_cast<std::streamsize>(raw.text->size()));
+        }
+    }
+
     void Print(const Document& doc, ostream& output) {
         auto json_type = doc.GetRoot().GetJsonType();
         std::visit([&output](const auto& value) {
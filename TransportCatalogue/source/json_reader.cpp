@@ -1,11 +1,15 @@
 #include "json_reader.h"
 #include "json_builder.h"
 
+#include <algorithm>
+
 namespace transport_catalogue::store {
 	using namespace std::literals;
 
 	void JsonParser::operator()(nullptr_t /*null*/) {}
 
+	void JsonParser::operator()(const json::RawJson& /*raw*/) {}	// во входных данных не встречается
+
 	void JsonParser::operator()(const bool& value) {
 		data_route->is_roundtrip = value;
 	}
@@ -66,10 +70,9 @@ namespace transport_catalogue::store {
 	}
 
 	void AddBusToCatalogue(const DataRoute& data_route, TransportCatalogue& catalogue) {
-		std::vector<Stop*> bus_route;
+		std::vector<uint32_t> bus_route;
 		for (const std::string& stop : data_route.bus_route) {
-			Stop* struct_stop = catalogue.GetAllStops().find(stop)->second;
-			bus_route.push_back(struct_stop);
+			bus_route.push_back(catalogue.FindStop(stop)->id);
 		}
 		catalogue.AddBus(data_route.bus_name, bus_route, data_route.is_roundtrip);
 	}
@@ -83,18 +86,26 @@ namespace transport_catalogue::store {
 		return dict_node;
 	}
 
-	json::Node RequestStop(const RequestHandler& handler, const json::Node& value) {
-		const std::set<std::string_view>* buses = handler.GetBusesByStop(value.AsDict().at("name").AsString());
-		if (buses == nullptr) {
+	json::Node RequestStop(const RequestHandler& handler, const json::Node& value,
+		std::vector<std::shared_ptr<const std::string>>& stop_buses_json) {
+		const std::string& stop_name = value.AsDict().at("name").AsString();
+		const std::optional<uint32_t> stop_id = handler.GetStopId(stop_name);
+		if (!stop_id) {
 			return SaveEmptyAnswer(value);
 		}
-		json::Array arr;
-		for (std::string_view stop : *buses) {
-			arr.push_back(std::string(stop));
+		std::shared_ptr<const std::string>& buses_json = stop_buses_json[*stop_id];
+		if (buses_json == nullptr) {
+			json::Array arr;
+			for (std::string_view stop : handler.GetBusesByStop(*stop_id)) {
+				arr.push_back(std::string(stop));
+			}
+			std::ostringstream out;
+			json::PrintObj(out, arr);
+			buses_json = std::make_shared<const std::string>(out.str());
 		}
 		json::Node dict_node_stop{ json::Builder{}
 									.StartDict()
-										.Key("buses"s).Value(arr)
+										.Key("buses"s).Value(json::RawJson{ buses_json })
 										.Key("request_id"s).Value(value.AsDict().at("id").AsInt())
 									.EndDict().Build() };
 		return dict_node_stop;
@@ -146,6 +157,99 @@ namespace transport_catalogue::store {
 					 .EndDict().Build() };
 		return node_route;
 	}
+
+	bool IsParetoRequest(const json::Node& value) {
+		const auto it = value.AsDict().find("pareto"s);
+		return it != value.AsDict().end() && it->second.AsBool();
+	}
+
+	json::Node RequestParetoRoute(const RequestHandler& handler, const json::Node& value) {
+		std::vector<std::vector<route::RouteData>> routes = handler.CreateParetoRoutes(value.AsDict().at("from").AsString(), value.AsDict().at("to").AsString());
+		if (routes.empty()) {
+			return CreateRouteAnswer(value, std::nullopt);
+		}
+
+		json::Array arr_routes;
+		for (const std::vector<route::RouteData>& route_data : routes) {
+			const int bus_count = static_cast<int>(std::count_if(route_data.begin(), route_data.end(), [](const route::RouteData& data) {
+				return data.type == "bus"sv;
+			}));
+			arr_routes.push_back(json::Builder{}.StartDict()
+											.Key("items"s).Value(CreateNodeRoute(route_data).AsArray())
+											.Key("total_time"s).Value(CalcTotalTime(route_data))
+											.Key("transfer_count"s).Value(std::max(bus_count - 1, 0))
+											.EndDict().Build());
+		}
+		return json::Builder{}.StartDict()
+								.Key("request_id"s).Value(value.AsDict().at("id"s).AsInt())
+								.Key("routes"s).Value(std::move(arr_routes))
+								.EndDict().Build();
+	}
+
+	size_t ReadAlternativesCount(const json::Node& value) {
+		const auto it = value.AsDict().find("alternatives"s);
+		if (it == value.AsDict().end()) {
+			return 0;
+		}
+		if (it->second.AsInt() < 0) {
+			throw std::invalid_argument("Negative alternatives count"s);
+		}
+		return static_cast<size_t>(it->second.AsInt());
+	}
+
+	json::Node RequestAlternativeRoutes(const RequestHandler& handler, const json::Node& value) {
+		std::vector<std::vector<route::RouteData>> routes = handler.CreateAlternativeRoutes(value.AsDict().at("from").AsString(),
+			value.AsDict().at("to").AsString(), ReadAlternativesCount(value));
+		if (routes.empty()) {
+			return CreateRouteAnswer(value, std::nullopt);
+		}
+
+		json::Array arr_routes;
+		for (const std::vector<route::RouteData>& route_data : routes) {
+			arr_routes.push_back(json::Builder{}.StartDict()
+											.Key("items"s).Value(CreateNodeRoute(route_data).AsArray())
+											.Key("total_time"s).Value(CalcTotalTime(route_data))
+											.EndDict().Build());
+		}
+		return json::Builder{}.StartDict()
+								.Key("request_id"s).Value(value.AsDict().at("id"s).AsInt())
+								.Key("routes"s).Value(std::move(arr_routes))
+								.EndDict().Build();
+	}
+
+	std::vector<json::Node> RequestRoutes(const RequestHandler& handler, const json::Node& node) {
+		const json::Array& requests = node.AsArray();
+		std::unordered_map<std::string_view, std::vector<size_t>> requests_by_origin;
+		std::vector<json::Node> answers(requests.size());
+		for (size_t index = 0; index < requests.size(); ++index) {
+			const json::Dict& request = requests[index].AsDict();
+			if (request.empty() || request.at("type").AsString() != "Route") {
+				continue;
+			}
+			if (IsParetoRequest(requests[index])) {
+				answers[index] = RequestParetoRoute(handler, requests[index]);
+			}
+			else if (ReadAlternativesCount(requests[index]) > 0) {
+				answers[index] = RequestAlternativeRoutes(handler, requests[index]);
+			}
+			else {
+				requests_by_origin[request.at("from").AsString()].push_back(index);
+			}
+		}
+
+		std::vector<std::string_view> to_list;
+		for (const auto& [from, indexes] : requests_by_origin) {
+			to_list.clear();
+			for (size_t index : indexes) {
+				to_list.push_back(requests[index].AsDict().at("to").AsString());
+			}
+			std::vector<std::optional<std::vector<route::RouteData>>> routes = handler.CreateRoutes(from, to_list);
+			for (size_t i = 0; i < indexes.size(); ++i) {
+				answers[indexes[i]] = CreateRouteAnswer(requests[indexes[i]], routes[i]);
+			}
+		}
+		return answers;
+	}
 	
 	json::Node CreateNodeRoute(const std::vector<route::RouteData>& route_data) {
 		json::Node data_route{ json::Builder{}.StartArray().EndArray().Build() };
@@ -176,7 +280,10 @@ namespace transport_catalogue::store {
 		return total_time;
 	}
 	json::Node RequestRoute(const RequestHandler& handler, const json::Node& value) {
-		std::optional<std::vector<route::RouteData>> route_data = handler.CreateRoute(value.AsDict().at("from").AsString(), value.AsDict().at("to").AsString());
+		return CreateRouteAnswer(value, handler.CreateRoute(value.AsDict().at("from").AsString(), value.AsDict().at("to").AsString()));
+	}
+
+	json::Node CreateRouteAnswer(const json::Node& value, const std::optional<std::vector<route::RouteData>>& route_data) {
 		if (route_data == std::nullopt) {
 			json::Node err_node{ json::Builder{}.StartDict()
 													.Key("error_message").Value("not found")
@@ -194,14 +301,83 @@ namespace transport_catalogue::store {
 		return node_route;
 	}
 
+	std::vector<std::string_view> ReadStopNames(const json::Node& node) {
+		std::vector<std::string_view> names;
+		names.reserve(node.AsArray().size());
+		for (const auto& name : node.AsArray()) {
+			names.push_back(name.AsString());
+		}
+		return names;
+	}
+
+	json::Node RequestMatrix(const RequestHandler& handler, const json::Node& value) {
+		std::optional<route::TransportRouter::TimeMatrix> matrix = handler.CreateTimeMatrix(ReadStopNames(value.AsDict().at("from"s)),
+			ReadStopNames(value.AsDict().at("to"s)));
+		if (matrix == std::nullopt) {
+			return CreateRouteAnswer(value, std::nullopt);
+		}
+
+		json::Array arr_times;
+		arr_times.reserve(matrix->size());
+		for (const auto& row : *matrix) {
+			json::Array arr_row;
+			arr_row.reserve(row.size());
+			for (const std::optional<double>& time : row) {	// null — пути нет
+				arr_row.push_back(time ? json::Node(*time) : json::Node(nullptr));
+			}
+			arr_times.push_back(std::move(arr_row));
+		}
+		return json::Builder{}.StartDict()
+								.Key("request_id"s).Value(value.AsDict().at("id"s).AsInt())
+								.Key("times"s).Value(std::move(arr_times))
+								.EndDict().Build();
+	}
+
+	json::Node RequestIsochrone(const RequestHandler& handler, const json::Node& value) {
+		std::optional<std::vector<route::ReachableStop>> stops = handler.CreateIsochrone(value.AsDict().at("from"s).AsString(),
+			value.AsDict().at("max_time"s).AsDouble());
+		if (stops == std::nullopt) {
+			return CreateRouteAnswer(value, std::nullopt);
+		}
+
+		json::Array arr_stops;
+		arr_stops.reserve(stops->size());
+		for (const route::ReachableStop& stop : *stops) {
+			arr_stops.push_back(json::Builder{}.StartDict()
+												.Key("stop_name"s).Value(std::string(stop.stop_name))
+												.Key("time"s).Value(stop.time)
+												.EndDict().Build());
+		}
+		return json::Builder{}.StartDict()
+								.Key("request_id"s).Value(value.AsDict().at("id"s).AsInt())
+								.Key("stops"s).Value(std::move(arr_stops))
+								.EndDict().Build();
+	}
+
+	bool HasRouteRequests(const json::Node& node) {
+		for (const auto& value : node.AsArray()) {
+			if (value.AsDict().empty()) {
+				continue;
+			}
+			const std::string& type = value.AsDict().at("type").AsString();
+			if (type == "Route" || type == "Matrix" || type == "Isochrone") {
+				return true;
+			}
+		}
+		return false;
+	}
+
 	void StatRequests(const json::Node& node, const RequestHandler& handler) {
 		json::Array arr_answer;
-		for (const auto& value : node.AsArray()) {
+		std::vector<json::Node> route_answers = RequestRoutes(handler, node);	// Маршруты считаются пакетами по начальной остановке
+		std::vector<std::shared_ptr<const std::string>> stop_buses_json(handler.GetStopCount());	// список "buses" по id остановки
+		for (size_t index = 0; index < node.AsArray().size(); ++index) {
+			const json::Node& value = node.AsArray()[index];
 			if (value.AsDict().empty()) {
 				continue;
 			}
 			if (value.AsDict().at("type").AsString() == "Stop") {
-				json::Node dict_node_stop = RequestStop(handler, value);
+				json::Node dict_node_stop = RequestStop(handler, value, stop_buses_json);
 				arr_answer.push_back(std::move(dict_node_stop));
 				continue;
 			}
@@ -216,8 +392,15 @@ namespace transport_catalogue::store {
 				continue;
 			}
 			if (value.AsDict().at("type").AsString() == "Route") {
-				json::Node dict_node_route = RequestRoute(handler, value);
-				arr_answer.push_back(std::move(dict_node_route));
+				arr_answer.push_back(std::move(route_answers[index]));
+				continue;
+			}
+			if (value.AsDict().at("type").AsString() == "Matrix") {
+				arr_answer.push_back(RequestMatrix(handler, value));
+				continue;
+			}
+			if (value.AsDict().at("type").AsString() == "Isochrone") {
+				arr_answer.push_back(RequestIsochrone(handler, value));
 				continue;
 			}
 		}
@@ -252,6 +435,7 @@ namespace transport_catalogue::store {
 				AddBusToCatalogue(data_route, catalogue);
 			}
 		}
+		catalogue.Finalize();
 	}
 
 	svg::Color ReadTypeColor(const json::Node& node) {
@@ -336,6 +520,40 @@ namespace transport_catalogue::store {
 		}
 	}		
 
+	route::RouterEngine ReadRouterEngine(const json::Node& node) {
+		const std::string& engine = node.AsString();
+		if (engine == "dijkstra"sv) {
+			return route::RouterEngine::DIJKSTRA;
+		}
+		if (engine == "bidirectional_dijkstra"sv) {
+			return route::RouterEngine::BIDIRECTIONAL_DIJKSTRA;
+		}
+		if (engine == "contraction_hierarchies"sv) {
+			return route::RouterEngine::CONTRACTION_HIERARCHIES;
+		}
+		if (engine == "a_star"sv) {
+			return route::RouterEngine::A_STAR;
+		}
+		if (engine == "raptor"sv) {
+			return route::RouterEngine::RAPTOR;
+		}
+		if (engine == "floyd_warshall"sv) {
+			return route::RouterEngine::FLOYD_WARSHALL;
+		}
+		throw std::invalid_argument("Unknown router engine: "s + engine);
+	}
+
+	route::GraphModel ReadGraphModel(const json::Node& node) {
+		const std::string& model = node.AsString();
+		if (model == "linear"sv) {
+			return route::GraphModel::LINEAR;
+		}
+		if (model == "complete"sv) {
+			return route::GraphModel::COMPLETE;
+		}
+		throw std::invalid_argument("Unknown graph model: "s + model);
+	}
+
 	void ReadRouteSetting(const json::Node& node, route::RouteSettings& route_settings) {
 		for (const auto& [key, value] : node.AsDict()) {
 			if (key == "bus_velocity"sv) {
@@ -346,6 +564,33 @@ namespace transport_catalogue::store {
 				route_settings.bus_wait_time = value.AsInt();
 				continue;
 			}
+			if (key == "router_engine"sv) {
+				route_settings.engine = ReadRouterEngine(value);
+				continue;
+			}
+			if (key == "graph_model"sv) {
+				route_settings.graph_model = ReadGraphModel(value);
+				continue;
+			}
+			if (key == "huge_pages"sv) {
+				route_settings.use_huge_pages = value.AsBool();
+				continue;
+			}
+			if (key == "router_cache_file"sv) {
+				route_settings.cache_file = value.AsString();
+				continue;
+			}
+			if (key == "integer_weights"sv) {
+				route_settings.use_integer_weights = value.AsBool();
+				continue;
+			}
+			if (key == "tree_cache_mb"sv) {
+				if (value.AsInt() < 0) {
+					throw std::invalid_argument("Negative tree cache size"s);
+				}
+				route_settings.tree_cache_size = static_cast<size_t>(value.AsInt()) * 1024 * 1024;
+				continue;
+			}
 		}
 	}
 
@@ -356,6 +601,8 @@ namespace transport_catalogue::store {
 
 			auto value = json_type.at("base_requests");
 			BaseRequests(value, catalogue);
+			// Дальше справочник только читается
+			const std::shared_ptr<const CatalogueSnapshot> snapshot = catalogue.Freeze();
 			
 			renderer::Settings settings;
 			
@@ -367,11 +614,14 @@ namespace transport_catalogue::store {
 			value = json_type.at("routing_settings");
 			ReadRouteSetting(value, route_setting);
 
-			route::TransportRouter router(catalogue, route_setting);
+			value = json_type.at("stat_requests");
+			std::optional<route::TransportRouter> router;
+			if (HasRouteRequests(value)) {
+				router.emplace(snapshot, route_setting);
+			}
 			renderer::MapRenderer map_render(settings);
-			RequestHandler handler(catalogue, map_render, router);
+			RequestHandler handler(*snapshot, map_render, router ? &*router : nullptr);
 
-			value = json_type.at("stat_requests");
 			StatRequests(value, handler);
 		}
 		catch (const std::logic_error& err) {
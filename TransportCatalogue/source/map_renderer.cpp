@@ -25,13 +25,13 @@ namespace renderer {
 		return { text_1 , text_2 };
 	}
 
-	std::optional<svg::Polyline> MapRenderer::CreateRouteLine(const domain::Bus* bus, const SphereProjector& sphere_proj) const {
+	std::optional<svg::Polyline> MapRenderer::CreateRouteLine(const BusView* bus, const CatalogueSnapshot& catalogue, const SphereProjector& sphere_proj) const {
 		svg::Polyline polyline;
 		if (bus->bus_route.empty()) {
 			return std::nullopt;
 		}
-		for (domain::Stop* stop : bus->bus_route) {
-			svg::Point point = sphere_proj(stop->coordinates);
+		for (uint32_t stop_id : bus->bus_route) {
+			svg::Point point = sphere_proj(catalogue.GetStop(stop_id)->coordinates);
 			polyline.AddPoint(point).SetStrokeColor(settings_.color_palette[color_count_]).SetFillColor(svg::NoneColor).
 									 SetStrokeWidth(settings_.line_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND).
 									 SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
@@ -41,7 +41,7 @@ namespace renderer {
 			return polyline; 
 		}
 		for (auto it_back = bus->bus_route.rbegin() + 1; it_back != bus->bus_route.rend(); ++it_back) {
-			svg::Point point = sphere_proj((*it_back)->coordinates);
+			svg::Point point = sphere_proj(catalogue.GetStop(*it_back)->coordinates);
 			polyline.AddPoint(point).SetStrokeColor(settings_.color_palette[color_count_]).SetFillColor(svg::NoneColor).
 									 SetStrokeWidth(settings_.line_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND).
 									 SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
@@ -50,20 +50,20 @@ namespace renderer {
 		return polyline;
 	}
 
-	std::vector<std::pair<svg::Text, svg::Text>> MapRenderer::CreateRouteName(const domain::Bus* bus, const SphereProjector& sphere_proj) const {
+	std::vector<std::pair<svg::Text, svg::Text>> MapRenderer::CreateRouteName(const BusView* bus, const CatalogueSnapshot& catalogue, const SphereProjector& sphere_proj) const {
 		if (bus->bus_route.empty()) {
 			return {};
 		}
-		svg::Point point = sphere_proj(bus->bus_route.front()->coordinates);
-		auto [text_1, text_2] = FillingText(bus->name, point);
+		svg::Point point = sphere_proj(catalogue.GetStop(bus->bus_route.front())->coordinates);
+		auto [text_1, text_2] = FillingText(std::string(bus->name), point);
 		if (bus->is_roundtrip || (bus->bus_route.size() == 1) || (bus->bus_route.front() == bus->bus_route.back())) {
 			const_cast<MapRenderer*>(this)->ChangeCountColor();
 			return { { text_1, text_2 } };
 		}
 		std::vector<std::pair<svg::Text, svg::Text>> result;
 		result.push_back( {text_1, text_2} );
-		point = sphere_proj(bus->bus_route.back()->coordinates);
-		auto [text_1_, text_2_] = FillingText(bus->name, point);
+		point = sphere_proj(catalogue.GetStop(bus->bus_route.back())->coordinates);
+		auto [text_1_, text_2_] = FillingText(std::string(bus->name), point);
 		result.push_back({ text_1_, text_2_ });
 		const_cast<MapRenderer*>(this)->ChangeCountColor();
 		return result;
@@ -82,12 +82,12 @@ namespace renderer {
 		svg::Point point = sphere_proj(stop->coordinates);
 		text_1.SetPosition(point).SetOffset(settings_.stop_label_offset).
 			SetFontSize(settings_.stop_label_font_size).SetFontFamily("Verdana"s).
-			SetData(stop->name).SetFillColor(settings_.underlayer_color).SetStrokeColor(settings_.underlayer_color).
+			SetData(std::string(stop->name)).SetFillColor(settings_.underlayer_color).SetStrokeColor(settings_.underlayer_color).
 			SetStrokeWidth(settings_.underlayer_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND).
 			SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 		text_2.SetPosition(point).SetOffset(settings_.stop_label_offset).
 			SetFontSize(settings_.stop_label_font_size).SetFontFamily("Verdana"s).
-			SetData(stop->name).SetFillColor("black");
+			SetData(std::string(stop->name)).SetFillColor("black");
 		return {text_1, text_2};
 	}
 
@@ -103,14 +103,14 @@ namespace renderer {
 		color_count_ = 0;
 	}
 
-	svg::Document MapRenderer::CreateMap(const TransportCatalogue& catalogue) const {
+	svg::Document MapRenderer::CreateMap(const CatalogueSnapshot& catalogue) const {
 		std::set<std::string_view> stops_names;
 		std::set<std::string_view> buses_names;
 		std::vector<geo::Coordinates> coordinates_stops;
-		const std::unordered_map <std::string_view, Bus*>& all_buses = catalogue.GetAllBuses();
-		for (const auto& [bus_name, struct_bus] : all_buses) {
-			buses_names.insert(bus_name);
-			for (Stop* stop : struct_bus->bus_route) {
+		for (const BusView& struct_bus : catalogue.GetBuses()) {
+			buses_names.insert(struct_bus.name);
+			for (uint32_t stop_id : struct_bus.bus_route) {
+				const Stop* stop = catalogue.GetStop(stop_id);
 				auto [_, status] = stops_names.insert(stop->name);
 				if (status) {
 					coordinates_stops.push_back(stop->coordinates);
@@ -120,7 +120,7 @@ namespace renderer {
 		renderer::SphereProjector sphere_proj(coordinates_stops.begin(), coordinates_stops.end(), settings_.width, settings_.height, settings_.padding);
 		svg::Document doc;
 		for (std::string_view bus : buses_names) {
-			std::optional<svg::Polyline> poly = this->CreateRouteLine(all_buses.at(bus), sphere_proj);
+			std::optional<svg::Polyline> poly = this->CreateRouteLine(catalogue.FindBus(bus), catalogue, sphere_proj);
 			if (poly == std::nullopt) {
 				continue;
 			}
@@ -128,7 +128,7 @@ namespace renderer {
 		}
 		this->ResetColorCount();
 		for (std::string_view bus : buses_names) {
-			auto text = this->CreateRouteName(all_buses.at(bus), sphere_proj);
+			auto text = this->CreateRouteName(catalogue.FindBus(bus), catalogue, sphere_proj);
 			if (text.empty()) {
 				continue;
 			}
@@ -139,13 +139,12 @@ namespace renderer {
 				doc.Add(text[1].second);
 			}
 		}
-		const std::unordered_map <std::string_view, Stop*>& all_stops = catalogue.GetAllStops();
 		for (std::string_view stop : stops_names) {
-			svg::Circle circle = this->CreateStopsSymbol(all_stops.at(stop), sphere_proj);
+			svg::Circle circle = this->CreateStopsSymbol(catalogue.FindStop(stop), sphere_proj);
 			doc.Add(circle);
 		}
 		for (std::string_view stop : stops_names) {
-			auto text = this->CreateStopsName(all_stops.at(stop), sphere_proj);
+			auto text = this->CreateStopsName(catalogue.FindStop(stop), sphere_proj);
 			doc.Add(text.first);
 			doc.Add(text.second);
 		}
@@ -0,0 +1,234 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+
+route::RaptorRouter::RaptorRouter(const CatalogueSnapshot& catalogue, const RouteSettings& route_setting) :
+	route_setting_(route_setting), stop_count_(catalogue.GetStops().size()) {
+	stop_names_.resize(stop_count_);
+	for (const Stop& stop : catalogue.GetStops()) {
+		stop_names_[stop.id] = stop.name;
+	}
+
+	std::vector<uint32_t> stops;
+	std::vector<double> distances;
+	for (const BusView& struct_bus : catalogue.GetBuses()) {
+		const ranges::Range<const uint32_t*> bus_route = struct_bus.bus_route;
+		stops.clear();
+		distances.clear();
+		for (size_t index = 0; index < bus_route.size(); ++index) {
+			stops.push_back(bus_route[index]);
+			distances.push_back(index == 0 ? 0.0 : distances.back() + GetSegmentLenght(struct_bus.lenghts, index - 1));
+		}
+		AddPattern(struct_bus.name, stops, distances);
+		if (!struct_bus.is_roundtrip) {
+			stops.clear();
+			distances.clear();
+			for (size_t index = bus_route.size(); index-- > 0;) {
+				stops.push_back(bus_route[index]);
+				distances.push_back(stops.size() == 1 ? 0.0 : distances.back() + GetSegmentLenght(struct_bus.back_lenghts, stops.size() - 2));
+			}
+			AddPattern(struct_bus.name, stops, distances);
+		}
+	}
+
+	stop_pattern_offsets_.assign(stop_count_ + 1, 0);
+	for (uint32_t stop : pattern_stops_) {
+		++stop_pattern_offsets_[stop + 1];
+	}
+	for (size_t stop = 0; stop < stop_count_; ++stop) {
+		stop_pattern_offsets_[stop + 1] += stop_pattern_offsets_[stop];
+	}
+	stop_patterns_.resize(pattern_stops_.size());
+	std::vector<uint32_t> positions(stop_pattern_offsets_.begin(), stop_pattern_offsets_.end() - 1);
+	for (uint32_t pattern = 0; pattern < patterns_.size(); ++pattern) {
+		for (uint32_t index = 0; index < patterns_[pattern].size; ++index) {
+			const uint32_t stop = pattern_stops_[patterns_[pattern].begin + index];
+			stop_patterns_[positions[stop]++] = { pattern, index };
+		}
+	}
+
+	best_arrivals_.resize(stop_count_);
+	marked_stops_.assign(stop_count_, 0);
+	pattern_starts_.assign(patterns_.size(), NO_INDEX);
+}
+
+void route::RaptorRouter::AddPattern(std::string_view bus_name, const std::vector<uint32_t>& stops, const std::vector<double>& distances) {
+	if (stops.size() < 2) {
+		return;
+	}
+	patterns_.push_back({ bus_name, static_cast<uint32_t>(pattern_stops_.size()), static_cast<uint32_t>(stops.size()) });
+	pattern_stops_.insert(pattern_stops_.end(), stops.begin(), stops.end());
+	pattern_distances_.insert(pattern_distances_.end(), distances.begin(), distances.end());
+}
+
+std::optional<std::vector<route::RouteData>> route::RaptorRouter::BuildRoute(size_t from, size_t to) const {
+	if (from == to) {
+		RouteData empty_answer;
+		empty_answer.type = "stay_here"sv;
+		return std::vector<RouteData>{ empty_answer };
+	}
+	RunRounds(from, to);
+	if (best_arrivals_[to] == INFINITE_TIME) {
+		return std::nullopt;
+	}
+	// Из раундов с лучшим временем берётся первый — меньше пересадок
+	size_t round = 1;
+	while (arrivals_[round][to] != best_arrivals_[to]) {
+		++round;
+	}
+	return ExtractRoute(round, to);
+}
+
+std::vector<std::vector<route::RouteData>> route::RaptorRouter::BuildParetoRoutes(size_t from, size_t to) const {
+	std::vector<std::vector<RouteData>> routes;
+	if (from == to) {
+		routes.push_back(BuildRoute(from, to).value());
+		return routes;
+	}
+	// Раунд k хранит лучшее время не более чем с k посадками, поэтому каждое строгое улучшение
+	// у цели — недоминируемая поездка ровно с k посадками
+	const size_t last_round = RunRounds(from, to);
+	for (size_t round = 1; round <= last_round; ++round) {
+		if (arrivals_[round][to] < arrivals_[round - 1][to]) {
+			routes.push_back(ExtractRoute(round, to));
+		}
+	}
+	return routes;
+}
+
+std::vector<std::optional<double>> route::RaptorRouter::BuildTimes(size_t from, const std::vector<size_t>& targets) const {
+	RunRounds(from, NO_STOP);
+	std::vector<std::optional<double>> times;
+	times.reserve(targets.size());
+	for (size_t to : targets) {
+		times.push_back(best_arrivals_[to] == INFINITE_TIME ? std::nullopt : std::optional<double>(best_arrivals_[to]));
+	}
+	return times;
+}
+
+std::vector<std::pair<size_t, double>> route::RaptorRouter::BuildReachable(size_t from, double max_time) const {
+	RunRounds(from, NO_STOP, max_time);
+	std::vector<std::pair<size_t, double>> reachable;
+	for (size_t stop = 0; stop < stop_count_; ++stop) {
+		if (best_arrivals_[stop] <= max_time) {
+			reachable.emplace_back(stop, best_arrivals_[stop]);
+		}
+	}
+	std::sort(reachable.begin(), reachable.end(), [](const auto& lhs, const auto& rhs) {
+		return lhs.second < rhs.second || (lhs.second == rhs.second && lhs.first < rhs.first);
+	});
+	return reachable;
+}
+
+size_t route::RaptorRouter::RunRounds(size_t from, size_t to, double max_time) const {
+	if (arrivals_.empty()) {
+		arrivals_.emplace_back(stop_count_);
+		labels_.emplace_back(stop_count_);
+	}
+	std::fill(arrivals_[0].begin(), arrivals_[0].end(), INFINITE_TIME);
+	std::fill(best_arrivals_.begin(), best_arrivals_.end(), INFINITE_TIME);
+	arrivals_[0][from] = 0.0;
+	best_arrivals_[from] = 0.0;
+	marked_list_.assign(1, static_cast<uint32_t>(from));
+	marked_stops_[from] = 1;
+
+	size_t last_round = 0;
+	while (ScanRound(last_round + 1, to, max_time)) {
+		++last_round;
+	}
+	return last_round;
+}
+
+bool route::RaptorRouter::ScanRound(size_t round, size_t to, double max_time) const {
+	queued_patterns_.clear();
+	for (uint32_t stop : marked_list_) {
+		marked_stops_[stop] = 0;
+		for (uint32_t i = stop_pattern_offsets_[stop]; i < stop_pattern_offsets_[stop + 1]; ++i) {
+			const auto [pattern, index] = stop_patterns_[i];
+			if (pattern_starts_[pattern] == NO_INDEX) {
+				queued_patterns_.push_back(pattern);
+				pattern_starts_[pattern] = index;
+			}
+			else {
+				pattern_starts_[pattern] = std::min(pattern_starts_[pattern], index);
+			}
+		}
+	}
+	marked_list_.clear();
+	if (queued_patterns_.empty()) {
+		return false;
+	}
+
+	if (arrivals_.size() == round) {
+		arrivals_.emplace_back(stop_count_);
+		labels_.emplace_back(stop_count_);
+	}
+	const std::vector<double>& previous_arrivals = arrivals_[round - 1];
+	std::vector<double>& arrivals = arrivals_[round];
+	std::vector<Label>& labels = labels_[round];
+	arrivals = previous_arrivals;
+	labels = labels_[round - 1];
+
+	const double wait = route_setting_.bus_wait_time * 60 * 1.0;
+	const double bus_speed = route_setting_.bus_velocity * 1.0 / 3.6;
+	for (uint32_t pattern : queued_patterns_) {
+		const Pattern& data = patterns_[pattern];
+		const uint32_t* stops = pattern_stops_.data() + data.begin;
+		const double* distances = pattern_distances_.data() + data.begin;
+		uint32_t board_index = NO_INDEX;
+		double board_time = INFINITE_TIME;
+		for (uint32_t index = pattern_starts_[pattern]; index < data.size; ++index) {
+			const uint32_t stop = stops[index];
+			double ride_time = INFINITE_TIME;
+			if (board_index != NO_INDEX) {
+				ride_time = board_time + (distances[index] - distances[board_index]) / bus_speed;
+				if (ride_time < best_arrivals_[stop] && ride_time <= max_time && (to == NO_STOP || ride_time < best_arrivals_[to])) {
+					arrivals[stop] = ride_time;
+					best_arrivals_[stop] = ride_time;
+					labels[stop] = { pattern, board_index, index };
+					if (!marked_stops_[stop]) {
+						marked_stops_[stop] = 1;
+						marked_list_.push_back(stop);
+					}
+				}
+			}
+			// Посадка здесь выгоднее, если с неё автобус «приезжает» сюда раньше текущего
+			if (previous_arrivals[stop] + wait < ride_time) {
+				board_index = index;
+				board_time = previous_arrivals[stop] + wait;
+			}
+		}
+		pattern_starts_[pattern] = NO_INDEX;
+	}
+	return true;
+}
+
+std::vector<route::RouteData> route::RaptorRouter::ExtractRoute(size_t round, size_t to) const {
+	std::vector<RouteData> route_data;
+	size_t stop = to;
+	for (; labels_[round][stop].pattern != NO_PATTERN; --round) {
+		const Label& label = labels_[round][stop];
+		const Pattern& pattern = patterns_[label.pattern];
+
+		RouteData bus_answer;
+		bus_answer.type = "bus"sv;
+		bus_answer.bus_name = pattern.bus_name;
+		bus_answer.span_count = static_cast<int>(label.alight_index - label.board_index);
+		bus_answer.motion_time = GetRideTime(label.pattern, label.board_index, label.alight_index) / 60;
+		route_data.push_back(std::move(bus_answer));
+
+		stop = pattern_stops_[pattern.begin + label.board_index];
+		RouteData stop_answer;
+		stop_answer.type = "stop"sv;
+		stop_answer.stop_name = stop_names_[stop];
+		stop_answer.bus_wait_time = route_setting_.bus_wait_time;
+		route_data.push_back(std::move(stop_answer));
+	}
+	std::reverse(route_data.begin(), route_data.end());
+	return route_data;
+}
+
+double route::RaptorRouter::GetRideTime(uint32_t pattern, uint32_t board_index, uint32_t alight_index) const {
+	const double* distances = pattern_distances_.data() + patterns_[pattern].begin;
+	return (distances[alight_index] - distances[board_index]) / (route_setting_.bus_velocity * 1.0 / 3.6);
+}
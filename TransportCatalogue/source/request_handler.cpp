@@ -1,15 +1,28 @@
 #include "request_handler.h"
 
 namespace req_handler {
-	RequestHandler::RequestHandler(const TransportCatalogue& catalogue, const renderer::MapRenderer& renderer, const TransportRouter& router)
+	RequestHandler::RequestHandler(const CatalogueSnapshot& catalogue, const renderer::MapRenderer& renderer, const TransportRouter* router)
 		: catalogue_(catalogue), renderer_(renderer), router_(router) {}
 
 	std::optional<BusRouteInfo> RequestHandler::GetBusStat(const std::string_view& bus_name) const {
 		return catalogue_.GetInfoRoute(bus_name);
 	}
 
-	const std::set<std::string_view>* RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
-		return catalogue_.GetInfoStop(stop_name);;
+	std::optional<ranges::Range<const std::string_view*>> RequestHandler::GetBusesByStop(const std::string_view& stop_name) const {
+		return catalogue_.GetInfoStop(stop_name);
+	}
+
+	ranges::Range<const std::string_view*> RequestHandler::GetBusesByStop(uint32_t stop_id) const {
+		return catalogue_.GetStopBusNames(stop_id);
+	}
+
+	std::optional<uint32_t> RequestHandler::GetStopId(const std::string_view& stop_name) const {
+		const Stop* stop = catalogue_.FindStop(stop_name);
+		return stop != nullptr ? std::optional<uint32_t>(stop->id) : std::nullopt;
+	}
+
+	size_t RequestHandler::GetStopCount() const {
+		return catalogue_.GetStops().size();
 	}
 
 	svg::Document RequestHandler::RenderMap() const {
@@ -17,6 +30,47 @@ namespace req_handler {
 	}
 
 	std::optional<std::vector<route::RouteData>> RequestHandler::CreateRoute(const std::string_view& from, const std::string_view& to) const {
-		return router_.CreatRoute(from, to);
+		if (router_ == nullptr) {
+			return std::nullopt;
+		}
+		return router_->CreatRoute(from, to);
+	}
+
+	std::vector<std::optional<std::vector<route::RouteData>>> RequestHandler::CreateRoutes(const std::string_view& from,
+		const std::vector<std::string_view>& to_list) const {
+		if (router_ == nullptr) {
+			return std::vector<std::optional<std::vector<route::RouteData>>>(to_list.size());
+		}
+		return router_->CreatRoutes(from, to_list);
+	}
+
+	std::optional<route::TransportRouter::TimeMatrix> RequestHandler::CreateTimeMatrix(const std::vector<std::string_view>& from_list,
+		const std::vector<std::string_view>& to_list) const {
+		if (router_ == nullptr) {
+			return std::nullopt;
+		}
+		return router_->CreatTimeMatrix(from_list, to_list);
+	}
+
+	std::optional<std::vector<route::ReachableStop>> RequestHandler::CreateIsochrone(const std::string_view& from, double max_time) const {
+		if (router_ == nullptr) {
+			return std::nullopt;
+		}
+		return router_->CreatIsochrone(from, max_time);
+	}
+
+	std::vector<std::vector<route::RouteData>> RequestHandler::CreateAlternativeRoutes(const std::string_view& from, const std::string_view& to,
+		size_t alternatives_count) const {
+		if (router_ == nullptr) {
+			return {};
+		}
+		return router_->CreatAlternativeRoutes(from, to, alternatives_count);
+	}
+
+	std::vector<std::vector<route::RouteData>> RequestHandler::CreateParetoRoutes(const std::string_view& from, const std::string_view& to) const {
+		if (router_ == nullptr) {
+			return {};
+		}
+		return router_->CreatParetoRoutes(from, to);
 	}
 }
\ No newline at end of file
@@ -1,89 +1,246 @@
 #include "transport_catalogue.h"
+#include "catalogue_snapshot.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
 
 namespace transport_catalogue {
 	namespace store {
-		void TransportCatalogue::AddBus(const std::string& name, std::vector<Stop*> bus_route, bool is_roundtrip) {
+		const std::string& TransportCatalogue::StoreName(std::string name) {
+			names_.push_back(std::move(name));
+			return names_.back();
+		}
+
+		void TransportCatalogue::AddBus(const std::string& name, std::vector<uint32_t> bus_route, bool is_roundtrip) {
+			if (bus_ids_.Find(name) != nullptr) {
+				return;
+			}
 			Bus bus;
-			bus.name = name;
+			bus.name = StoreName(name);
 			bus.bus_route = move(bus_route);
 			bus.is_roundtrip = is_roundtrip;
-			deq_buses_.push_back(std::move(bus));
-			all_buses_[deq_buses_.back().name] = &deq_buses_.back();
-			for (auto stop : deq_buses_.back().bus_route) {
-				stop_buses_[stop->name].insert(deq_buses_.back().name);
+			bus.id = static_cast<uint32_t>(buses_.size());
+			ComputeSegmentLenghts(bus);
+			buses_.push_back(std::move(bus));
+			const Bus& added_bus = buses_.back();
+			bus_ids_.Insert(added_bus.name, added_bus.id);
+			if (!route_infos_.empty()) {
+				route_infos_.push_back(ComputeRouteInfo(&added_bus));
+			}
+			for (uint32_t stop_id : added_bus.bus_route) {
+				stop_bus_names_[stop_id].insert(added_bus.name);
+				std::vector<uint32_t>& buses = stop_buses_[stop_id];
+				if (buses.empty() || buses.back() != added_bus.id) {
+					buses.push_back(added_bus.id);
+				}
 			}
 		}
 
 		void TransportCatalogue::AddStop(std::string stop_name, geo::Coordinates coordinates) {
-			if (all_stops_.count(stop_name)) {
+			if (stop_ids_.Find(stop_name) != nullptr) {
 				return;
 			}
 			Stop stop_bus;
 			stop_bus.coordinates = std::move(coordinates);
-			stop_bus.name = move(stop_name);
-			stop_bus.id = all_stops_.size();
-			deq_stops_.push_back(std::move(stop_bus));
-			all_stops_[deq_stops_.back().name] = &deq_stops_.back();
-			stop_buses_[deq_stops_.back().name];
+			stop_bus.name = StoreName(move(stop_name));
+			stop_bus.id = static_cast<uint32_t>(stops_.size());
+			stops_.push_back(stop_bus);
+			stop_ids_.Insert(stop_bus.name, stop_bus.id);
+			stop_bus_names_.emplace_back();
+			stop_buses_.emplace_back();
+			distances_.emplace_back();
+		}
+
+		void TransportCatalogue::Finalize() {
+			std::vector<std::pair<std::string_view, uint32_t>> items;
+			items.reserve(stops_.size());
+			for (const Stop& stop : stops_) {
+				items.push_back({ stop.name, stop.id });
+			}
+			stop_index_ = std::make_shared<const detail::PerfectHashIndex>(items);
+			items.clear();
+			for (const Bus& bus : buses_) {
+				items.push_back({ bus.name, bus.id });
+			}
+			bus_index_ = std::make_shared<const detail::PerfectHashIndex>(items);
+			ComputeRouteInfos();
+		}
+
+		std::shared_ptr<const CatalogueSnapshot> TransportCatalogue::Freeze() {
+			const auto is_stale = [](const std::shared_ptr<const detail::PerfectHashIndex>& index, size_t name_count) {
+				return index == nullptr || (name_count - index->GetSize()) * UNINDEXED_NAMES_FRACTION > name_count;
+			};
+			if (is_stale(stop_index_, stops_.size()) || is_stale(bus_index_, buses_.size())) {
+				Finalize();
+			}
+			else {
+				ComputeRouteInfos();
+			}
+			return std::make_shared<const CatalogueSnapshot>(*this);
+		}
+
+		// Имена из индекса находятся в нём, добавленные после Finalize — в хэш-таблице
+		std::optional<uint32_t> TransportCatalogue::FindStopId(std::string_view name_stop) const {
+			if (stop_index_ != nullptr) {
+				const std::optional<uint32_t> id = stop_index_->Find(name_stop, [this](uint32_t id) {
+					return stops_[id].name;
+				});
+				if (id || stop_index_->GetSize() == stops_.size()) {
+					return id;
+				}
+			}
+			const uint32_t* id = stop_ids_.Find(name_stop);
+			return id != nullptr ? std::optional<uint32_t>(*id) : std::nullopt;
+		}
+
+		std::optional<uint32_t> TransportCatalogue::FindBusId(std::string_view name_bus) const {
+			if (bus_index_ != nullptr) {
+				const std::optional<uint32_t> id = bus_index_->Find(name_bus, [this](uint32_t id) {
+					return buses_[id].name;
+				});
+				if (id || bus_index_->GetSize() == buses_.size()) {
+					return id;
+				}
+			}
+			const uint32_t* id = bus_ids_.Find(name_bus);
+			return id != nullptr ? std::optional<uint32_t>(*id) : std::nullopt;
 		}
 
 		const Bus* TransportCatalogue::FindBus(std::string_view name_bus) const {
-			return (all_buses_.find(name_bus) != all_buses_.end() ? all_buses_.at(name_bus) : nullptr);
+			const std::optional<uint32_t> id = FindBusId(name_bus);
+			return (id ? &buses_[*id] : nullptr);
 		}
 
 		const Stop* TransportCatalogue::FindStop(std::string_view name_stop) const {
-			return (all_stops_.find(name_stop) != all_stops_.end() ? all_stops_.at(name_stop) : nullptr);
+			const std::optional<uint32_t> id = FindStopId(name_stop);
+			return (id ? &stops_[*id] : nullptr);
+		}
+
+		const Stop* TransportCatalogue::GetStop(size_t id) const {
+			return &stops_.at(id);
+		}
+
+		const Bus* TransportCatalogue::GetBus(size_t id) const {
+			return &buses_.at(id);
 		}
 
 		void TransportCatalogue::SetDistance(const std::string& first_stop_name, const std::string& second_stop_name, const double& distance) {
-			auto first_stop = all_stops_.find(first_stop_name)->second;
-			if (second_stop_name.empty()) {
-				distance_.insert({ { first_stop, nullptr}, distance });
+			const std::optional<uint32_t> first_stop = FindStopId(first_stop_name);
+			const std::optional<uint32_t> second_stop = FindStopId(second_stop_name);
+			if (!first_stop || !second_stop) {
+				return;
 			}
-			else {
-				auto second_stop = all_stops_.find(second_stop_name)->second;
-				distance_.insert({ { first_stop, second_stop }, distance });
+			// Повторный вызов меняет расстояние (после него нужен TransportRouter::UpdateDistance)
+			GetDistanceEntry(*first_stop, *second_stop) = { *second_stop, true, distance };
+			Distance& back_entry = GetDistanceEntry(*second_stop, *first_stop);
+			if (!back_entry.is_forward) {
+				back_entry.lenght = distance;
+			}
+			// Перегоны first -> second и second -> first есть только у автобусов через first
+			for (uint32_t bus_id : stop_buses_[*first_stop]) {
+				ComputeSegmentLenghts(buses_[bus_id]);
+				if (bus_id < route_infos_.size()) {
+					route_infos_[bus_id] = ComputeRouteInfo(&buses_[bus_id]);
+				}
 			}
 		}
 
-		const std::unordered_map <std::string_view, Stop*>& TransportCatalogue::GetAllStops() const {
-			return all_stops_;
+		TransportCatalogue::Distance& TransportCatalogue::GetDistanceEntry(uint32_t first_stop, uint32_t second_stop) {
+			std::vector<Distance>& entries = distances_[first_stop];
+			auto it = std::lower_bound(entries.begin(), entries.end(), second_stop, [](const Distance& entry, uint32_t stop_id) {
+				return entry.stop_id < stop_id;
+			});
+			if (it == entries.end() || it->stop_id != second_stop) {
+				it = entries.insert(it, { second_stop, false, 0.0 });
+			}
+			return *it;
 		}
 
-		const std::unordered_map <std::string_view, Bus*>& TransportCatalogue::GetAllBuses() const {
-			return all_buses_;
+		void TransportCatalogue::ComputeSegmentLenghts(Bus& bus) const {
+			const std::vector<uint32_t>& route = bus.bus_route;
+			const size_t segment_count = route.empty() ? 0 : route.size() - 1;
+			bus.lenghts.resize(segment_count);
+			for (size_t index = 0; index < segment_count; ++index) {
+				bus.lenghts[index] = GetLenght(route[index], route[index + 1]).value_or(std::nan(""));
+			}
+			bus.back_lenghts.resize(bus.is_roundtrip ? 0 : segment_count);
+			for (size_t index = 0; index < bus.back_lenghts.size(); ++index) {
+				bus.back_lenghts[index] = GetLenght(route[segment_count - index], route[segment_count - index - 1]).value_or(std::nan(""));
+			}
 		}
 
-		const std::optional<double> TransportCatalogue::GetLenght(const Stop* first_stop, const Stop* second_stop) const {
-			auto it_lenght = distance_.find({ first_stop, second_stop });
-			if (it_lenght == distance_.end()) {
-				it_lenght = distance_.find({ second_stop, first_stop });
-				if (it_lenght == distance_.end()) {
-					return std::nullopt;
-				}
+		const std::vector<Stop>& TransportCatalogue::GetStops() const {
+			return stops_;
+		}
+
+		const std::vector<Bus>& TransportCatalogue::GetBuses() const {
+			return buses_;
+		}
+
+		const std::optional<double> TransportCatalogue::GetLenght(uint32_t first_stop, uint32_t second_stop) const {
+			const std::vector<Distance>& entries = distances_[first_stop];
+			const auto it = std::lower_bound(entries.begin(), entries.end(), second_stop, [](const Distance& entry, uint32_t stop_id) {
+				return entry.stop_id < stop_id;
+			});
+			if (it == entries.end() || it->stop_id != second_stop) {
+				return std::nullopt;
 			}
-			return it_lenght->second;
+			return it->lenght;
 		}
 
 		size_t TransportCatalogue::GetUniqueStops(const Bus* bus) const {
-			std::set<std::string_view> unique_stops;
-			for (auto struct_stop : bus->bus_route) {
-				auto stop = all_stops_.find(struct_stop->name)->first;
-				unique_stops.insert(stop);
+			std::vector<uint32_t> unique_stops = bus->bus_route;
+			std::sort(unique_stops.begin(), unique_stops.end());
+			return std::unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin();
+		}
+
+		// Считаются только недостающие сведения: остальные AddBus и SetDistance поддерживают сами.
+		// Автобусы делятся на полосы по потокам, каждый поток пишет только в свою часть route_infos_
+		void TransportCatalogue::ComputeRouteInfos() {
+			const size_t first_bus = route_infos_.size();
+			if (first_bus == buses_.size()) {
+				return;
+			}
+			route_infos_.resize(buses_.size());
+			const size_t bus_count = buses_.size() - first_bus;
+			const size_t hardware_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+			const size_t thread_count = std::clamp<size_t>(bus_count / MIN_BUSES_PER_THREAD, 1, hardware_threads);
+			const auto compute_stripe = [this](size_t begin, size_t end) {
+				for (size_t bus_id = begin; bus_id < end; ++bus_id) {
+					route_infos_[bus_id] = ComputeRouteInfo(&buses_[bus_id]);
+				}
+			};
+			std::vector<std::thread> threads;
+			threads.reserve(thread_count - 1);
+			const size_t stripe = (bus_count + thread_count - 1) / thread_count;
+			for (size_t thread_index = 1; thread_index < thread_count; ++thread_index) {
+				const size_t begin = std::min(buses_.size(), first_bus + thread_index * stripe);
+				threads.emplace_back(compute_stripe, begin, std::min(buses_.size(), begin + stripe));
+			}
+			compute_stripe(first_bus, std::min(buses_.size(), first_bus + stripe));
+			for (std::thread& thread : threads) {
+				thread.join();
 			}
-			return unique_stops.size();
 		}
 
 		const std::optional<BusRouteInfo> TransportCatalogue::GetInfoRoute(std::string_view name_bus) const {
 			const Bus* bus = FindBus(name_bus);
-			BusRouteInfo route_info;
 			if (bus == nullptr) {
 				return std::nullopt;
 			}
+			if (bus->id < route_infos_.size()) {
+				return route_infos_[bus->id];
+			}
+			return ComputeRouteInfo(bus);
+		}
+
+		BusRouteInfo TransportCatalogue::ComputeRouteInfo(const Bus* bus) const {
+			BusRouteInfo route_info;
 			route_info.stops = (bus->is_roundtrip == true ? bus->bus_route.size() : bus->bus_route.size() * 2 - 1);
 			route_info.unique_stops = std::move(GetUniqueStops(bus));
 			if (!bus->bus_route.empty()) {
-				auto [lenght, curvature] = GetAllLenght(bus->bus_route.begin(), bus->bus_route.end());
+				auto [lenght, curvature] = GetAllLenght(bus->bus_route.begin(), bus->bus_route.end(), bus->lenghts.begin());
 				route_info.lenght = lenght;
 				route_info.curvature = curvature;
 			}
@@ -92,7 +249,7 @@ namespace transport_catalogue {
 				return route_info;
 			}
 			if (!bus->bus_route.empty()) {
-				auto [lenght, curvature] = GetAllLenght(bus->bus_route.rbegin(), bus->bus_route.rend());
+				auto [lenght, curvature] = GetAllLenght(bus->bus_route.rbegin(), bus->bus_route.rend(), bus->back_lenghts.begin());
 				route_info.lenght += lenght;
 				route_info.curvature += curvature;
 			}
@@ -101,10 +258,23 @@ namespace transport_catalogue {
 		}
 
 		const std::set<std::string_view>* TransportCatalogue::GetInfoStop(std::string_view stop) const {
-			if (stop_buses_.find(stop) != stop_buses_.end()) {
-				return &stop_buses_.at(stop);
+			const std::optional<uint32_t> id = FindStopId(stop);
+			if (id) {
+				return &stop_bus_names_[*id];
 			}
 			return nullptr;
 		}
+
+		const std::vector<uint32_t>& TransportCatalogue::GetStopBuses(uint32_t stop_id) const {
+			return stop_buses_.at(stop_id);
+		}
+
+		std::shared_ptr<const detail::PerfectHashIndex> TransportCatalogue::GetStopIndex() const {
+			return stop_index_;
+		}
+
+		std::shared_ptr<const detail::PerfectHashIndex> TransportCatalogue::GetBusIndex() const {
+			return bus_index_;
+		}
 	}
-}
\ No newline at end of file
+}
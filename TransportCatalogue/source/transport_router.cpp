@@ -1,14 +1,286 @@
 #include "transport_router.h"
+#include "raptor_router.h"
 
-route::TransportRouter::TransportRouter(const TransportCatalogue& catalogue, const RouteSettings& route_setting) :
-	catalogue_(catalogue), route_setting_(route_setting), graph_(catalogue.GetAllStops().size()) {
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void route::EdgesInfo::Add(size_t from_stop, size_t to_stop, size_t bus, size_t span_count, EdgeType type) {
+	if (span_count > std::numeric_limits<uint16_t>::max()) {
+		throw std::length_error("Bus route is too long for the edge span counter");
+	}
+	from_stops.push_back(static_cast<uint32_t>(from_stop));
+	to_stops.push_back(static_cast<uint32_t>(to_stop));
+	buses.push_back(static_cast<uint32_t>(bus));
+	span_counts.push_back(static_cast<uint16_t>(span_count));
+	types.push_back(type);
+}
+
+route::TransportRouter::TransportRouter(std::shared_ptr<const CatalogueSnapshot> catalogue, const RouteSettings& route_setting) :
+	catalogue_(std::move(catalogue)), route_setting_(route_setting), tree_cache_(route_setting.tree_cache_size) {
+}
+
+route::TransportRouter::~TransportRouter() = default;
+
+bool route::TransportRouter::IsInitialized() const {
+	if (route_setting_.engine == RouterEngine::RAPTOR) {
+		return raptor_ != nullptr;
+	}
+	return router_ != nullptr;
+}
+
+const route::RaptorRouter& route::TransportRouter::GetRaptorRouter() const {
+	if (raptor_ == nullptr) {
+		raptor_ = std::make_unique<RaptorRouter>(*catalogue_, route_setting_);
+	}
+	return *raptor_;
+}
+
+const graph::DijkstraRouter<double>& route::TransportRouter::GetDijkstraRouter() const {
+	if (const auto* dijkstra = dynamic_cast<const graph::DijkstraRouter<double>*>(router_.get())) {
+		return *dijkstra;
+	}
+	if (reach_router_ == nullptr) {
+		reach_router_ = std::make_unique<graph::DijkstraRouter<double>>(graph_);
+	}
+	return *reach_router_;
+}
+
+void route::TransportRouter::Initialize() const {
+	if (IsInitialized()) {
+		return;
+	}
+	if (route_setting_.engine == RouterEngine::RAPTOR) {
+		GetRaptorRouter();
+		return;
+	}
+	PrepareGraph();
+	router_ = CreateEngine();
+	if (route_setting_.tree_cache_size > 0) {
+		tree_router_ = dynamic_cast<const graph::DijkstraRouter<double>*>(router_.get());
+	}
+}
+
+void route::TransportRouter::PrepareGraph() const {
+	if (graph_.IsFrozen()) {
+		return;
+	}
+	graph_ = Graph(CountVertices());
 	BuildGraph();
-	router_ = std::make_unique<graph::Router<double>>(graph_);
+	graph_.Freeze();
+}
+
+const graph::ShortestPathTreeCache<double>& route::TransportRouter::GetTreeCache() const {
+	return tree_cache_;
+}
+
+std::optional<route::TransportRouter::RouteInfo> route::TransportRouter::BuildRoute(graph::VertexId from, graph::VertexId to) const {
+	if (tree_router_ == nullptr) {
+		return router_->BuildRoute(from, to);
+	}
+	const auto& tree = tree_cache_.GetOrBuild(from, [this](graph::VertexId root) {
+		return tree_router_->BuildTree(root);
+	});
+	return tree_router_->BuildRoute(tree, to);
+}
+
+std::vector<std::optional<route::TransportRouter::RouteInfo>> route::TransportRouter::BuildRoutes(graph::VertexId from,
+	const std::vector<graph::VertexId>& targets) const {
+	if (tree_router_ == nullptr) {
+		return router_->BuildRoutes(from, targets);
+	}
+	const auto& tree = tree_cache_.GetOrBuild(from, [this](graph::VertexId root) {
+		return tree_router_->BuildTree(root);
+	});
+	std::vector<std::optional<RouteInfo>> routes;
+	routes.reserve(targets.size());
+	for (const graph::VertexId to : targets) {
+		routes.push_back(tree_router_->BuildRoute(tree, to));
+	}
+	return routes;
 }
 
 std::optional<std::vector<route::RouteData>> route::TransportRouter::CreatRoute(const std::string_view& from, const std::string_view& to) const {
-	std::optional<graph::Router<double>::RouteInfo> route_info = router_->BuildRoute(catalogue_.FindStop(from)->id, catalogue_.FindStop(to)->id);
+	Initialize();
+	if (route_setting_.engine == RouterEngine::RAPTOR) {
+		return raptor_->BuildRoute(catalogue_->FindStop(from)->id, catalogue_->FindStop(to)->id);
+	}
+	return CreateRouteData(BuildRoute(catalogue_->FindStop(from)->id, catalogue_->FindStop(to)->id));
+}
+
+std::vector<std::vector<route::RouteData>> route::TransportRouter::CreatParetoRoutes(const std::string_view& from, const std::string_view& to) const {
+	const Stop* from_stop = catalogue_->FindStop(from);
+	const Stop* to_stop = catalogue_->FindStop(to);
+	if (from_stop == nullptr || to_stop == nullptr) {
+		return {};
+	}
+	return GetRaptorRouter().BuildParetoRoutes(from_stop->id, to_stop->id);
+}
+
+std::vector<std::vector<route::RouteData>> route::TransportRouter::CreatAlternativeRoutes(const std::string_view& from,
+	const std::string_view& to, size_t alternatives_count) const {
+	const Stop* from_stop = catalogue_->FindStop(from);
+	const Stop* to_stop = catalogue_->FindStop(to);
+	if (from_stop == nullptr || to_stop == nullptr) {
+		return {};
+	}
+	PrepareGraph();
+	if (alternatives_router_ == nullptr) {
+		alternatives_router_ = std::make_unique<graph::KShortestPaths<double>>(graph_);
+	}
+	// Пересадки на тот же автобус дают много почти одинаковых путей, поэтому перебор с запасом
+	constexpr size_t PATHS_PER_ROUTE = 16;
+	const size_t route_count = alternatives_count + 1;
+	// Два ребра BUS подряд одного автобуса — высадка и посадка обратно. Путь отбрасывается, если тот же
+	// автобус везёт от первой посадки до второй высадки одним ребром не дольше: это копия поездки без
+	// высадки. Пересадка на конечной в обратную сторону быстрее любой поездки насквозь и остаётся.
+	// В линейной модели путь без циклов не возвращается в ту же вершину поездки, отбрасывать нечего
+	const auto is_distinct = [this](const RouteInfo& route_info) {
+		for (size_t index = 1; index < route_info.edges.size(); ++index) {
+			const graph::EdgeId first_id = route_info.edges[index - 1];
+			const graph::EdgeId second_id = route_info.edges[index];
+			if (edges_info_.types[first_id] != EdgeType::BUS || edges_info_.types[second_id] != EdgeType::BUS
+				|| edges_info_.buses[first_id] != edges_info_.buses[second_id]) {
+				continue;
+			}
+			const graph::Edge<double>& first = graph_.GetEdge(first_id);
+			const graph::Edge<double>& second = graph_.GetEdge(second_id);
+			for (const graph::EdgeId edge_id : graph_.GetIncidentEdges(first.from)) {
+				const graph::Edge<double>& edge = graph_.GetEdge(edge_id);
+				if (edge.to == second.to && edges_info_.types[edge_id] == EdgeType::BUS
+					&& edges_info_.buses[edge_id] == edges_info_.buses[first_id] && edge.weight <= first.weight + second.weight) {
+					return false;
+				}
+			}
+		}
+		return true;
+	};
+	std::vector<std::vector<RouteData>> routes;
+	for (const RouteInfo& route_info : alternatives_router_->BuildRoutes(from_stop->id, to_stop->id,
+		route_count, route_count * PATHS_PER_ROUTE, is_distinct)) {
+		routes.push_back(CreateRouteData(route_info).value());
+	}
+	return routes;
+}
+
+std::optional<route::TransportRouter::TimeMatrix> route::TransportRouter::CreatTimeMatrix(const std::vector<std::string_view>& from_list,
+	const std::vector<std::string_view>& to_list) const {
+	std::vector<graph::VertexId> sources;
+	std::vector<graph::VertexId> targets;
+	if (!FindStopIds(from_list, sources) || !FindStopIds(to_list, targets)) {
+		return std::nullopt;
+	}
+	Initialize();
+	TimeMatrix matrix;
+	if (route_setting_.engine == RouterEngine::RAPTOR) {
+		for (graph::VertexId from : sources) {
+			matrix.push_back(raptor_->BuildTimes(from, targets));
+		}
+	}
+	else if (route_setting_.engine == RouterEngine::FLOYD_WARSHALL || route_setting_.engine == RouterEngine::CONTRACTION_HIERARCHIES) {
+		matrix = router_->BuildDistanceTable(sources, targets);
+	}
+	else {
+		// Одно дерево на строку вместо |from_list| × |to_list| поисков с восстановлением путей
+		const graph::DijkstraRouter<double>& dijkstra = GetDijkstraRouter();
+		for (const graph::VertexId from : sources) {
+			graph::ShortestPathTree<double> built_tree;
+			const graph::ShortestPathTree<double>* tree = &built_tree;
+			if (tree_router_ != nullptr) {
+				tree = &tree_cache_.GetOrBuild(from, [this](graph::VertexId root) {
+					return tree_router_->BuildTree(root);
+				});
+			}
+			else {
+				built_tree = dijkstra.BuildTree(from);
+			}
+			std::vector<std::optional<double>>& row = matrix.emplace_back();
+			row.reserve(targets.size());
+			for (const graph::VertexId to : targets) {
+				row.push_back(tree->IsReached(to) ? std::optional<double>(tree->weights[to]) : std::nullopt);
+			}
+		}
+	}
+	for (auto& row : matrix) {
+		for (std::optional<double>& time : row) {
+			if (time) {
+				*time /= 60;
+			}
+		}
+	}
+	return matrix;
+}
+
+std::optional<std::vector<route::ReachableStop>> route::TransportRouter::CreatIsochrone(const std::string_view& from, double max_time) const {
+	const Stop* from_stop = catalogue_->FindStop(from);
+	if (from_stop == nullptr) {
+		return std::nullopt;
+	}
+	Initialize();
+	std::vector<std::pair<size_t, double>> reachable;
+	if (route_setting_.engine == RouterEngine::RAPTOR) {
+		reachable = raptor_->BuildReachable(from_stop->id, max_time * 60);
+	}
+	else {
+		// Вершины поездки линейной модели в ответ не попадают, только остановки
+		const size_t stop_count = catalogue_->GetStops().size();
+		for (const auto& [vertex, weight] : GetDijkstraRouter().BuildReachable(from_stop->id, max_time * 60)) {
+			if (vertex < stop_count) {
+				reachable.emplace_back(vertex, weight);
+			}
+		}
+	}
+
+	std::vector<ReachableStop> stops;
+	stops.reserve(reachable.size());
+	for (const auto& [stop_id, time] : reachable) {
+		stops.push_back({ catalogue_->GetStop(stop_id)->name, time / 60 });
+	}
+	std::sort(stops.begin(), stops.end(), [](const ReachableStop& lhs, const ReachableStop& rhs) {
+		return lhs.time < rhs.time || (lhs.time == rhs.time && lhs.stop_name < rhs.stop_name);
+	});
+	return stops;
+}
 
+bool route::TransportRouter::FindStopIds(const std::vector<std::string_view>& names, std::vector<graph::VertexId>& ids) const {
+	ids.clear();
+	ids.reserve(names.size());
+	for (const std::string_view& name : names) {
+		const Stop* stop = catalogue_->FindStop(name);
+		if (stop == nullptr) {
+			return false;
+		}
+		ids.push_back(stop->id);
+	}
+	return true;
+}
+
+std::vector<std::optional<std::vector<route::RouteData>>> route::TransportRouter::CreatRoutes(const std::string_view& from,
+	const std::vector<std::string_view>& to_list) const {
+	Initialize();
+	if (route_setting_.engine == RouterEngine::RAPTOR) {
+		std::vector<std::optional<std::vector<RouteData>>> routes;
+		routes.reserve(to_list.size());
+		for (const std::string_view& to : to_list) {
+			routes.push_back(raptor_->BuildRoute(catalogue_->FindStop(from)->id, catalogue_->FindStop(to)->id));
+		}
+		return routes;
+	}
+	std::vector<graph::VertexId> targets;
+	targets.reserve(to_list.size());
+	for (const std::string_view& to : to_list) {
+		targets.push_back(catalogue_->FindStop(to)->id);
+	}
+
+	std::vector<std::optional<std::vector<RouteData>>> routes;
+	routes.reserve(to_list.size());
+	for (const std::optional<RouteInfo>& route_info : BuildRoutes(catalogue_->FindStop(from)->id, targets)) {
+		routes.push_back(CreateRouteData(route_info));
+	}
+	return routes;
+}
+
+std::optional<std::vector<route::RouteData>> route::TransportRouter::CreateRouteData(const std::optional<RouteInfo>& route_info) const {
 	if (route_info == std::nullopt) {
 		return std::nullopt;
 	}
@@ -20,29 +292,254 @@ std::optional<std::vector<route::RouteData>> route::TransportRouter::CreatRoute(
 	return CreateAnswer(route_info);
 }
 
+size_t route::TransportRouter::CountVertices() const {
+	size_t vertex_count = catalogue_->GetStops().size();
+	for (const BusView& struct_bus : catalogue_->GetBuses()) {
+		vertex_count += CountRideVertices(struct_bus);
+	}
+	return vertex_count;
+}
+
+size_t route::TransportRouter::CountRideVertices(const BusView& bus) const {
+	if (route_setting_.graph_model != GraphModel::LINEAR) {
+		return 0;
+	}
+	return bus.bus_route.size() * (bus.is_roundtrip ? 1 : 2);
+}
+
 void route::TransportRouter::BuildGraph() const {
-	const std::unordered_map <std::string_view, Bus*>& all_buses = catalogue_.GetAllBuses();
-	for (const auto& [bus_name, struct_bus] : all_buses) {
-		CreateEdgesAlongRoute(struct_bus->bus_route.begin(), struct_bus->bus_route.end(), bus_name);
-		if (!struct_bus->is_roundtrip) {
-			CreateEdgesAlongRoute(struct_bus->bus_route.rbegin(), struct_bus->bus_route.rend(), bus_name);
+	stop_count_ = catalogue_->GetStops().size();
+	next_ride_vertex_ = stop_count_;
+	bus_edges_.assign(catalogue_->GetBuses().size(), {});
+	for (const BusView& struct_bus : catalogue_->GetBuses()) {
+		AddBusEdges(struct_bus);
+	}
+}
+
+void route::TransportRouter::AddBusEdges(const BusView& bus) const {
+	if (bus.id >= bus_edges_.size()) {
+		bus_edges_.resize(bus.id + 1);
+	}
+	BusEdges& bus_edges = bus_edges_[bus.id];
+	bus_edges.begin = graph_.GetEdgeCount();
+	bus_edges.first_ride_vertex = next_ride_vertex_;
+	next_ride_vertex_ += ForEachBusEdge(bus, next_ride_vertex_, [this, &bus](const graph::Edge<double>& edge,
+		size_t from_stop, size_t to_stop, size_t span_count, EdgeType type) {
+		graph_.AddEdge(edge);
+		edges_info_.Add(from_stop, to_stop, bus.id, span_count, type);
+	});
+	bus_edges.end = graph_.GetEdgeCount();
+}
+
+void route::TransportRouter::AddBus(std::shared_ptr<const CatalogueSnapshot> catalogue, std::string_view bus_name) {
+	const BusView* bus = catalogue->FindBus(bus_name);
+	if (bus == nullptr) {
+		throw std::invalid_argument("Unknown bus: "s + std::string(bus_name));
+	}
+	raptor_.reset();	// RAPTOR строится за линейное время, проще построить заново
+	catalogue_ = std::move(catalogue);
+	if (!graph_.IsFrozen()) {	// граф ещё не строился
+		return;
+	}
+	if (catalogue_->GetStops().size() != stop_count_) {
+		Reset();
+		return;
+	}
+	if (bus->id < bus_edges_.size() && bus_edges_[bus->id].begin != bus_edges_[bus->id].end) {
+		throw std::logic_error("Bus is already in the route graph: "s + std::string(bus->name));
+	}
+	const graph::EdgeId first_edge = graph_.GetEdgeCount();
+	graph_.Unfreeze();
+	graph_.AddVertices(CountRideVertices(*bus));
+	AddBusEdges(*bus);
+	graph_.Freeze();
+
+	std::vector<graph::EdgeUpdate<double>> updates;
+	updates.reserve(graph_.GetEdgeCount() - first_edge);
+	for (graph::EdgeId edge_id = first_edge; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+		updates.push_back({ edge_id, std::nullopt });
+	}
+	ApplyUpdates(updates);
+}
+
+void route::TransportRouter::UpdateDistance(std::shared_ptr<const CatalogueSnapshot> catalogue, std::string_view from, std::string_view to) {
+	const Stop* from_stop = catalogue->FindStop(from);
+	if (from_stop == nullptr || catalogue->FindStop(to) == nullptr) {
+		throw std::invalid_argument("Unknown stop");
+	}
+	raptor_.reset();
+	catalogue_ = std::move(catalogue);
+	if (!graph_.IsFrozen()) {	// граф ещё не строился
+		return;
+	}
+	if (catalogue_->GetStops().size() != stop_count_) {
+		Reset();
+		return;
+	}
+	// Перегон from -> to и обратный без своего расстояния проходят только автобусы через from
+	std::vector<graph::EdgeUpdate<double>> updates;
+	for (const uint32_t bus_id : catalogue_->GetStopBuses(from_stop->id)) {
+		const BusView* bus = catalogue_->GetBus(bus_id);
+		if (bus->id >= bus_edges_.size() || bus_edges_[bus->id].begin == bus_edges_[bus->id].end) {
+			continue;	// автобуса ещё нет в графе
+		}
+		graph::EdgeId edge_id = bus_edges_[bus->id].begin;
+		ForEachBusEdge(*bus, bus_edges_[bus->id].first_ride_vertex, [this, &edge_id, &updates](const graph::Edge<double>& edge,
+			size_t, size_t, size_t, EdgeType) {
+			const double old_weight = graph_.GetEdge(edge_id).weight;
+			if (edge.weight != old_weight) {
+				graph_.SetEdgeWeight(edge_id, edge.weight);
+				updates.push_back({ edge_id, old_weight });
+			}
+			++edge_id;
+		});
+	}
+	ApplyUpdates(updates);
+}
+
+void route::TransportRouter::Reset() {
+	router_.reset();
+	tree_router_ = nullptr;
+	reach_router_.reset();
+	alternatives_router_.reset();
+	tree_cache_.Clear();
+	raptor_.reset();
+	graph_ = Graph();
+	edges_info_ = EdgesInfo{};
+	bus_edges_.clear();
+}
+
+void route::TransportRouter::ApplyUpdates(const std::vector<graph::EdgeUpdate<double>>& updates) {
+	if (updates.empty()) {
+		return;
+	}
+	// Дерево устарело, если в нём было подорожавшее ребро или через новое либо подешевевшее ребро
+	// какая-то вершина достижима быстрее
+	tree_cache_.EraseIf([this, &updates](const graph::ShortestPathTree<double>& tree) {
+		if (tree.weights.size() != graph_.GetVertexCount()) {
+			return true;
+		}
+		for (const graph::EdgeUpdate<double>& update : updates) {
+			const graph::Edge<double>& edge = graph_.GetEdge(update.edge_id);
+			if (update.old_weight && *update.old_weight < edge.weight) {
+				if (tree.prev_edges[edge.to] == update.edge_id) {
+					return true;
+				}
+			}
+			else if (tree.IsReached(edge.from)
+				&& (!tree.IsReached(edge.to) || tree.weights[edge.from] + edge.weight < tree.weights[edge.to])) {
+				return true;
+			}
+		}
+		return false;
+	});
+	alternatives_router_.reset();	// обратные рёбра копируются при построении
+	if (router_ != nullptr && !router_->ApplyUpdates(updates)) {
+		router_ = CreateEngine();
+		tree_router_ = route_setting_.tree_cache_size > 0 ? dynamic_cast<const graph::DijkstraRouter<double>*>(router_.get()) : nullptr;
+	}
+	if (reach_router_ != nullptr && !reach_router_->ApplyUpdates(updates)) {
+		reach_router_.reset();
+	}
+}
+
+std::unique_ptr<graph::RouteEngine<double>> route::TransportRouter::CreateEngine() const {
+	switch (route_setting_.engine) {
+	case RouterEngine::DIJKSTRA:
+		return std::make_unique<graph::DijkstraRouter<double>>(graph_);
+	case RouterEngine::BIDIRECTIONAL_DIJKSTRA:
+		return std::make_unique<graph::BidirectionalDijkstraRouter<double>>(graph_);
+	case RouterEngine::CONTRACTION_HIERARCHIES:
+		return std::make_unique<graph::ContractionHierarchy<double>>(graph_);
+	case RouterEngine::A_STAR:
+		PrepareLowerBound();
+		return std::make_unique<graph::AStarRouter<double>>(graph_, [this](graph::VertexId vertex, graph::VertexId to) {
+			return GetLowerBound(vertex, to);
+		});
+	case RouterEngine::FLOYD_WARSHALL:
+	default:
+		if (route_setting_.use_integer_weights) {
+			constexpr double WEIGHT_UNIT = 0.1;	// секунды
+			return std::make_unique<graph::FixedPointRouter<double>>(graph_, WEIGHT_UNIT, route_setting_.use_huge_pages,
+				route_setting_.cache_file);
 		}
+		return std::make_unique<graph::Router<double>>(graph_, route_setting_.use_huge_pages, route_setting_.cache_file);
 	}
 }
 
-std::vector<route::RouteData> route::TransportRouter::CreateAnswer(const std::optional<graph::Router<double>::RouteInfo>& route_info) const {
+void route::TransportRouter::PrepareLowerBound() const {
+	vertex_coordinates_.assign(graph_.GetVertexCount(), geo::Coordinates{ 0.0, 0.0 });
+	for (const Stop& stop : catalogue_->GetStops()) {
+		vertex_coordinates_[stop.id] = stop.coordinates;
+	}
+	// Вершины поездки стоят там же, где остановка, с которой их связывает посадка или высадка
+	for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+		const auto& edge = graph_.GetEdge(edge_id);
+		if (edges_info_.types[edge_id] == EdgeType::WAIT) {
+			vertex_coordinates_[edge.to] = vertex_coordinates_[edge.from];
+		}
+		else if (edges_info_.types[edge_id] == EdgeType::TRANSFER) {
+			vertex_coordinates_[edge.from] = vertex_coordinates_[edge.to];
+		}
+	}
+	// Оценка c * расстояние по прямой согласована, если c не больше вес/расстояние для каждого ребра:
+	// дорожные расстояния бывают короче прямой, поэтому c берётся из графа, а не из скорости
+	time_per_meter_ = std::numeric_limits<double>::infinity();
+	for (graph::EdgeId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+		const auto& edge = graph_.GetEdge(edge_id);
+		const double distance = geo::ComputeDistance(vertex_coordinates_[edge.from], vertex_coordinates_[edge.to]);
+		if (distance > 0.0) {	// NaN и нулевые расстояния пропускаются
+			time_per_meter_ = std::min(time_per_meter_, edge.weight / distance);
+		}
+	}
+	// Запас покрывает погрешность acos в geo::ComputeDistance на близких точках
+	constexpr double ROUNDING_MARGIN = 0.99;
+	time_per_meter_ = std::isfinite(time_per_meter_) ? time_per_meter_ * ROUNDING_MARGIN : 0.0;
+}
+
+double route::TransportRouter::GetLowerBound(graph::VertexId vertex, graph::VertexId to) const {
+	// Для совпадающих точек acos может вернуть NaN — тогда оценка нулевая
+	const double distance = geo::ComputeDistance(vertex_coordinates_[vertex], vertex_coordinates_[to]);
+	return distance > 0.0 ? distance * time_per_meter_ : 0.0;
+}
+
+std::vector<route::RouteData> route::TransportRouter::CreateAnswer(const std::optional<RouteInfo>& route_info) const {
 	double total_time = 0.0;
 	std::vector<RouteData> route_data;
 
 	for (size_t edge_index : route_info.value().edges) {
+		switch (edges_info_.types[edge_index]) {
+		case EdgeType::WAIT:	// поездка копится в ответе об автобусе до высадки
+			route_data.push_back(std::move(CreateStopAnswer(edge_index)));
+			route_data.push_back(std::move(CreateBusAnswer(edge_index, 0.0)));
+			total_time += route_setting_.bus_wait_time;
+			continue;
+		case EdgeType::RIDE:
+			route_data.back().span_count += edges_info_.span_counts[edge_index];
+			route_data.back().motion_time += graph_.GetEdge(edge_index).weight;
+			continue;
+		case EdgeType::TRANSFER:
+			if (route_data.back().span_count == 0) {
+				route_data.pop_back();
+				route_data.pop_back();
+				total_time -= route_setting_.bus_wait_time;
+				continue;
+			}
+			route_data.back().motion_time /= 60;
+			total_time += route_data.back().motion_time;
+			continue;
+		case EdgeType::BUS:
+			break;
+		}
+
 		route_data.push_back(std::move(CreateStopAnswer(edge_index)));
 		total_time += route_setting_.bus_wait_time;
 	
-		if (edges_[edge_index].first == edges_[edge_index].second) {
+		if (edges_info_.from_stops[edge_index] == edges_info_.to_stops[edge_index]) {
 			continue;
 		}
 
-		double time = (edges_info_[edge_index].time_weight - route_setting_.bus_wait_time * 60) / 60;
+		double time = (graph_.GetEdge(edge_index).weight - route_setting_.bus_wait_time * 60) / 60;
 		total_time += time;
 
 		route_data.push_back(std::move(CreateBusAnswer(edge_index, time)));
@@ -53,8 +550,8 @@ std::vector<route::RouteData> route::TransportRouter::CreateAnswer(const std::op
 route::RouteData route::TransportRouter::CreateBusAnswer(size_t edge_index, double time) const {
 	RouteData bus_answer;
 	bus_answer.type = "bus"sv;
-	bus_answer.bus_name = edges_info_[edge_index].bus_name;
-	bus_answer.span_count = edges_info_[edge_index].span_count;
+	bus_answer.bus_name = catalogue_->GetBus(edges_info_.buses[edge_index])->name;
+	bus_answer.span_count = edges_info_.span_counts[edge_index];
 	bus_answer.motion_time = time;
 	return bus_answer;
 }
@@ -62,7 +559,7 @@ route::RouteData route::TransportRouter::CreateBusAnswer(size_t edge_index, doub
 route::RouteData route::TransportRouter::CreateStopAnswer(size_t edge_index) const {
 	RouteData stop_answer;
 	stop_answer.type = "stop"sv;
-	stop_answer.stop_name = edges_[edge_index].first;
+	stop_answer.stop_name = catalogue_->GetStop(edges_info_.from_stops[edge_index])->name;
 	stop_answer.bus_wait_time = route_setting_.bus_wait_time;
 	return stop_answer;
 }
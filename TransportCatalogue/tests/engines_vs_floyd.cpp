@@ -0,0 +1,320 @@
+// Сверка всех движков маршрутизации с Флойдом–Уоршеллом на случайных справочниках в обеих моделях графа:
+// для каждой пары остановок, включая совпадающие и недостижимые, должны совпасть время маршрута и ячейка
+// матрицы времён (на целочисленных весах — с точностью до округления рёбер). Альтернативы Йена начинаются
+// с того же времени, не убывают по времени и не повторяют остановок. Быстрейший из Парето-маршрутов
+// RAPTOR совпадает с эталоном.
+//
+// Сборка и запуск из каталога TransportCatalogue:
+//   g++ -std=c++17 -O2 -pthread -Iheader -o engines_vs_floyd tests/engines_vs_floyd.cpp $(ls source/*.cpp | grep -v /main.cpp)
+//   ./engines_vs_floyd
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace transport_catalogue::store;
+using namespace std::literals;
+
+namespace {
+	constexpr int CATALOGUE_COUNT = 20;
+	constexpr double TIME_EPSILON = 1e-9;
+	constexpr size_t ALTERNATIVES_COUNT = 3;
+	constexpr double WEIGHT_UNIT = 0.1 / 60.0;	// шаг целочисленных весов, в минутах
+
+	struct EngineCase {
+		std::string_view name;
+		route::RouterEngine engine;
+	};
+
+	const std::vector<EngineCase> ENGINE_CASES = {
+		{ "dijkstra", route::RouterEngine::DIJKSTRA },
+		{ "bidirectional", route::RouterEngine::BIDIRECTIONAL_DIJKSTRA },
+		{ "contraction_hierarchies", route::RouterEngine::CONTRACTION_HIERARCHIES },
+		{ "a_star", route::RouterEngine::A_STAR },
+		{ "raptor", route::RouterEngine::RAPTOR },
+	};
+
+	// Остановки с номерами от bus_stop_count и дальше ни в один маршрут не входят
+	void FillCatalogue(TransportCatalogue& catalogue, std::mt19937& generator) {
+		const int stop_count = std::uniform_int_distribution<int>(2, 40)(generator);
+		const int bus_stop_count = std::uniform_int_distribution<int>(2, stop_count)(generator);
+		const int bus_count = std::uniform_int_distribution<int>(1, 8)(generator);
+		std::uniform_real_distribution<double> coordinate(55.5, 55.9);
+		std::uniform_int_distribution<int> distance(100, 5000);
+		std::uniform_int_distribution<int> stop_index(0, bus_stop_count - 1);
+
+		for (int stop = 0; stop < stop_count; ++stop) {
+			catalogue.AddStop("S"s + std::to_string(stop), { coordinate(generator), coordinate(generator) });
+		}
+		for (int bus = 0; bus < bus_count; ++bus) {
+			const bool is_roundtrip = generator() % 2 == 0;
+			const int route_size = std::uniform_int_distribution<int>(2, 10)(generator);
+			std::vector<uint32_t> bus_route;
+			for (int index = 0; index < route_size; ++index) {
+				bus_route.push_back(static_cast<uint32_t>(stop_index(generator)));
+			}
+			if (is_roundtrip) {
+				bus_route.push_back(bus_route.front());
+			}
+			// Расстояние задано в одну сторону, обратное берётся из него
+			for (size_t index = 0; index + 1 < bus_route.size(); ++index) {
+				catalogue.SetDistance("S"s + std::to_string(bus_route[index]),
+					"S"s + std::to_string(bus_route[index + 1]), distance(generator));
+			}
+			catalogue.AddBus("B"s + std::to_string(bus), std::move(bus_route), is_roundtrip);
+		}
+	}
+
+	std::optional<double> GetTotalTime(const std::optional<std::vector<route::RouteData>>& route_data) {
+		if (!route_data) {
+			return std::nullopt;
+		}
+		double total_time = 0.0;
+		for (const route::RouteData& data : *route_data) {
+			if (data.type == "bus"sv) {
+				total_time += data.motion_time;
+			}
+			else if (data.type == "stop"sv) {
+				total_time += data.bus_wait_time;
+			}
+		}
+		return total_time;
+	}
+
+	// Эталонные времена Флойда–Уоршелла по всем парам остановок, [from][to]
+	using TimeTable = std::vector<std::vector<std::optional<double>>>;
+
+	TimeTable BuildExpectedTimes(const std::shared_ptr<const CatalogueSnapshot>& snapshot, route::RouteSettings settings) {
+		settings.engine = route::RouterEngine::FLOYD_WARSHALL;
+		const route::TransportRouter floyd(snapshot, settings);
+		TimeTable times;
+		for (const Stop& from : snapshot->GetStops()) {
+			std::vector<std::optional<double>>& row = times.emplace_back();
+			for (const Stop& to : snapshot->GetStops()) {
+				row.push_back(GetTotalTime(floyd.CreatRoute(from.name, to.name)));
+			}
+		}
+		return times;
+	}
+
+	bool IsSameTime(const std::optional<double>& expected, const std::optional<double>& actual, double tolerance) {
+		return expected.has_value() == actual.has_value() && (!expected || std::abs(*expected - *actual) <= tolerance);
+	}
+
+	void ReportMismatch(std::string_view check, const Stop& from, const Stop& to,
+		const std::optional<double>& expected, const std::optional<double>& actual) {
+		std::cerr << check << ' ' << from.name << " -> " << to.name << ": floyd "
+			<< (expected ? std::to_string(*expected) : "none"s) << ", got "
+			<< (actual ? std::to_string(*actual) : "none"s) << '\n';
+	}
+
+	// Число расхождений движка с эталоном по всем парам остановок
+	int CompareEngine(const std::shared_ptr<const CatalogueSnapshot>& snapshot, const route::RouteSettings& settings,
+		std::string_view name, const TimeTable& expected_times) {
+		const route::TransportRouter router(snapshot, settings);
+		int mismatches = 0;
+		for (const Stop& from : snapshot->GetStops()) {
+			for (const Stop& to : snapshot->GetStops()) {
+				const std::optional<double>& expected = expected_times[from.id][to.id];
+				const std::optional<double> actual = GetTotalTime(router.CreatRoute(from.name, to.name));
+				if (!IsSameTime(expected, actual, TIME_EPSILON * std::max(1.0, expected.value_or(0.0)))) {
+					ReportMismatch(name, from, to, expected, actual);
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	size_t CountVertices(const std::shared_ptr<const CatalogueSnapshot>& snapshot, route::GraphModel model) {
+		size_t vertex_count = snapshot->GetStops().size();
+		if (model == route::GraphModel::LINEAR) {
+			for (const BusView& bus : snapshot->GetBuses()) {
+				vertex_count += bus.bus_route.size() * (bus.is_roundtrip ? 1 : 2);
+			}
+		}
+		return vertex_count;
+	}
+
+	// Целочисленные веса округлены до WEIGHT_UNIT, каждое ребро ошибается не больше чем на половину шага.
+	// Путь без циклов короче числа вершин, поэтому найденный маршрут не быстрее эталона
+	// и медленнее его не больше чем на (вершины - 1) шагов
+	int CompareFixedPoint(const std::shared_ptr<const CatalogueSnapshot>& snapshot, route::RouteSettings settings,
+		const TimeTable& expected_times) {
+		settings.engine = route::RouterEngine::FLOYD_WARSHALL;
+		settings.use_integer_weights = true;
+		const route::TransportRouter router(snapshot, settings);
+		const double rounding_tolerance = static_cast<double>(CountVertices(snapshot, settings.graph_model) - 1) * WEIGHT_UNIT;
+		int mismatches = 0;
+		for (const Stop& from : snapshot->GetStops()) {
+			for (const Stop& to : snapshot->GetStops()) {
+				const std::optional<double>& expected = expected_times[from.id][to.id];
+				const std::optional<double> actual = GetTotalTime(router.CreatRoute(from.name, to.name));
+				const double epsilon = TIME_EPSILON * std::max(1.0, expected.value_or(0.0));
+				if (!IsSameTime(expected, actual, rounding_tolerance + epsilon) || (expected && *actual < *expected - epsilon)) {
+					ReportMismatch("integer_weights", from, to, expected, actual);
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	// Остановки посадки маршрута без повторов и без конечной: путь в графе не проходит вершину остановки дважды
+	bool IsLoopless(const std::vector<route::RouteData>& route_data, std::string_view to) {
+		std::vector<std::string_view> boarding_stops;
+		for (const route::RouteData& data : route_data) {
+			if (data.type == "stop"sv) {
+				boarding_stops.push_back(data.stop_name);
+			}
+		}
+		std::sort(boarding_stops.begin(), boarding_stops.end());
+		return std::adjacent_find(boarding_stops.begin(), boarding_stops.end()) == boarding_stops.end()
+			&& !std::binary_search(boarding_stops.begin(), boarding_stops.end(), to);
+	}
+
+	// Альтернативы Йена: первая совпадает с эталоном, времена не убывают, пути без циклов
+	int CheckAlternatives(const std::shared_ptr<const CatalogueSnapshot>& snapshot, route::RouteSettings settings,
+		const TimeTable& expected_times) {
+		settings.engine = route::RouterEngine::FLOYD_WARSHALL;
+		const route::TransportRouter router(snapshot, settings);
+		int mismatches = 0;
+		for (const Stop& from : snapshot->GetStops()) {
+			for (const Stop& to : snapshot->GetStops()) {
+				const std::optional<double>& expected = expected_times[from.id][to.id];
+				const std::vector<std::vector<route::RouteData>> routes = router.CreatAlternativeRoutes(from.name, to.name, ALTERNATIVES_COUNT);
+				const std::optional<double> actual = routes.empty() ? std::nullopt : GetTotalTime(routes.front());
+				if (!IsSameTime(expected, actual, TIME_EPSILON * std::max(1.0, expected.value_or(0.0)))) {
+					ReportMismatch("alternatives", from, to, expected, actual);
+					++mismatches;
+					continue;
+				}
+				if (routes.size() > ALTERNATIVES_COUNT + 1) {
+					std::cerr << "alternatives " << from.name << " -> " << to.name << ": " << routes.size() << " routes\n";
+					++mismatches;
+				}
+				double previous_time = 0.0;
+				for (const std::vector<route::RouteData>& route_data : routes) {
+					const double time = GetTotalTime(route_data).value();
+					if (time < previous_time - TIME_EPSILON * std::max(1.0, time)) {
+						std::cerr << "alternatives " << from.name << " -> " << to.name << ": " << time << " after " << previous_time << '\n';
+						++mismatches;
+					}
+					if (from.id != to.id && !IsLoopless(route_data, to.name)) {
+						std::cerr << "alternatives " << from.name << " -> " << to.name << ": repeated stop\n";
+						++mismatches;
+					}
+					previous_time = time;
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	int CountBoardings(const std::vector<route::RouteData>& route_data) {
+		return static_cast<int>(std::count_if(route_data.begin(), route_data.end(),
+			[](const route::RouteData& data) { return data.type == "bus"sv; }));
+	}
+
+	// Парето-маршруты RAPTOR: с каждой лишней посадкой строго быстрее, последний — с временем эталона
+	int CheckParetoRoutes(const std::shared_ptr<const CatalogueSnapshot>& snapshot, const route::RouteSettings& settings,
+		const TimeTable& expected_times) {
+		const route::TransportRouter router(snapshot, settings);
+		int mismatches = 0;
+		for (const Stop& from : snapshot->GetStops()) {
+			for (const Stop& to : snapshot->GetStops()) {
+				const std::optional<double>& expected = expected_times[from.id][to.id];
+				const std::vector<std::vector<route::RouteData>> routes = router.CreatParetoRoutes(from.name, to.name);
+				const std::optional<double> actual = routes.empty() ? std::nullopt : GetTotalTime(routes.back());
+				if (!IsSameTime(expected, actual, TIME_EPSILON * std::max(1.0, expected.value_or(0.0)))) {
+					ReportMismatch("pareto", from, to, expected, actual);
+					++mismatches;
+					continue;
+				}
+				for (size_t index = 1; index < routes.size(); ++index) {
+					if (CountBoardings(routes[index]) <= CountBoardings(routes[index - 1])
+						|| GetTotalTime(routes[index]).value() >= GetTotalTime(routes[index - 1]).value()) {
+						std::cerr << "pareto " << from.name << " -> " << to.name << ": route " << index << " is dominated\n";
+						++mismatches;
+					}
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	// Матрица времён по всем остановкам против эталонных CreatRoute
+	int CheckTimeMatrix(const std::shared_ptr<const CatalogueSnapshot>& snapshot, const route::RouteSettings& settings,
+		std::string_view name, const TimeTable& expected_times) {
+		const route::TransportRouter router(snapshot, settings);
+		std::vector<std::string_view> stop_names;
+		for (const Stop& stop : snapshot->GetStops()) {
+			stop_names.push_back(stop.name);
+		}
+		const route::TransportRouter::TimeMatrix matrix = router.CreatTimeMatrix(stop_names, stop_names).value();
+		int mismatches = 0;
+		for (const Stop& from : snapshot->GetStops()) {
+			for (const Stop& to : snapshot->GetStops()) {
+				const std::optional<double>& expected = expected_times[from.id][to.id];
+				const std::optional<double>& actual = matrix[from.id][to.id];
+				if (!IsSameTime(expected, actual, TIME_EPSILON * std::max(1.0, expected.value_or(0.0)))) {
+					ReportMismatch("matrix "s + std::string(name), from, to, expected, actual);
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	int CompareEngines(const std::shared_ptr<const CatalogueSnapshot>& snapshot, route::RouteSettings settings) {
+		const TimeTable expected_times = BuildExpectedTimes(snapshot, settings);
+		int mismatches = 0;
+		for (const EngineCase& engine_case : ENGINE_CASES) {
+			settings.engine = engine_case.engine;
+			mismatches += CompareEngine(snapshot, settings, engine_case.name, expected_times);
+			mismatches += CheckTimeMatrix(snapshot, settings, engine_case.name, expected_times);
+		}
+		settings.engine = route::RouterEngine::FLOYD_WARSHALL;
+		mismatches += CheckTimeMatrix(snapshot, settings, "floyd", expected_times);
+		mismatches += CompareFixedPoint(snapshot, settings, expected_times);
+		mismatches += CheckAlternatives(snapshot, settings, expected_times);
+		mismatches += CheckParetoRoutes(snapshot, settings, expected_times);
+		// Строки матрицы Дейкстры берутся из кэша деревьев, если он включён
+		settings.engine = route::RouterEngine::DIJKSTRA;
+		settings.tree_cache_size = 1024 * 1024;
+		mismatches += CheckTimeMatrix(snapshot, settings, "dijkstra_tree_cache", expected_times);
+		return mismatches;
+	}
+}
+
+int main() {
+	std::mt19937 generator(20240521);
+	int mismatches = 0;
+	for (int index = 0; index < CATALOGUE_COUNT; ++index) {
+		TransportCatalogue catalogue;
+		FillCatalogue(catalogue, generator);
+		const std::shared_ptr<const CatalogueSnapshot> snapshot = catalogue.Freeze();
+
+		route::RouteSettings settings;
+		settings.bus_wait_time = std::uniform_int_distribution<int>(1, 10)(generator);
+		settings.bus_velocity = std::uniform_int_distribution<int>(20, 60)(generator);
+		settings.tree_cache_size = 0;
+		for (const route::GraphModel model : { route::GraphModel::COMPLETE, route::GraphModel::LINEAR }) {
+			settings.graph_model = model;
+			mismatches += CompareEngines(snapshot, settings);
+		}
+	}
+	if (mismatches != 0) {
+		std::cerr << mismatches << " mismatches\n";
+		return 1;
+	}
+	std::cout << "OK\n";
+	return 0;
+}
@@ -0,0 +1,80 @@
+// Эталонные ответы: каждый вход прогоняется через ReadRequests, вывод сравнивается с ожидаемым побайтно.
+// Ожидаемые файлы получены сборкой до перехода справочника на плотные id и хэш-таблицы. С тех пор
+// отличается один ответ в catalogue.expected.json (запрос 112): автобусы 8 и 4K проходят Stop 13 -> Stop 42
+// за одно время, и раньше выбор между ними зависел от порядка обхода unordered_map, а теперь — от id автобуса.
+//
+// Сборка и запуск из каталога TransportCatalogue:
+//   g++ -std=c++17 -O2 -pthread -Iheader -o golden_test tests/golden_test.cpp $(ls source/*.cpp | grep -v /main.cpp)
+//   ./golden_test
+
+#include "json_reader.h"
+#include "transport_catalogue.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace transport_catalogue::store;
+
+namespace {
+	struct GoldenCase {
+		std::string input;
+		std::string expected;
+	};
+
+	const std::vector<GoldenCase> GOLDEN_CASES = {
+		{ "output/input.json", "tests/golden/input.expected.json" },
+		{ "tests/golden/catalogue.json", "tests/golden/catalogue.expected.json" },
+	};
+
+	std::string ReadFile(const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("cannot open " + path);
+		}
+		return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	}
+
+	// Ответы ReadRequests печатаются в std::cout, на время прогона он пишет в строку
+	std::string Run(const std::string& input_path) {
+		std::ifstream input(input_path, std::ios::binary);
+		if (!input) {
+			throw std::runtime_error("cannot open " + input_path);
+		}
+		std::ostringstream output;
+		std::streambuf* cout_buffer = std::cout.rdbuf(output.rdbuf());
+		try {
+			TransportCatalogue catalogue;
+			ReadRequests(input, catalogue);
+		}
+		catch (...) {
+			std::cout.rdbuf(cout_buffer);
+			throw;
+		}
+		std::cout.rdbuf(cout_buffer);
+		return output.str();
+	}
+}
+
+int main() {
+	int failures = 0;
+	for (const GoldenCase& golden_case : GOLDEN_CASES) {
+		const std::string actual = Run(golden_case.input);
+		const std::string expected = ReadFile(golden_case.expected);
+		if (actual == expected) {
+			std::cout << golden_case.input << ": OK\n";
+			continue;
+		}
+		size_t position = 0;
+		while (position < actual.size() && position < expected.size() && actual[position] == expected[position]) {
+			++position;
+		}
+		std::cerr << golden_case.input << ": differs from " << golden_case.expected << " at byte " << position << '\n';
+		++failures;
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// Файл матриц Флойда–Уоршелла (router_cache_file): второй запуск на том же справочнике отображает файл
+// и отвечает так же, как первый. После смены одного расстояния отпечаток графа другой, файл не подходит
+// и пересчитывается, ответы совпадают с роутером без файла. Что файл загружен, а не перезаписан, видно
+// по времени изменения: сохранение идёт через переименование временного файла.
+//
+// Сборка и запуск из каталога TransportCatalogue:
+//   g++ -std=c++17 -O2 -pthread -Iheader -o router_cache_file tests/router_cache_file.cpp $(ls source/*.cpp | grep -v /main.cpp)
+//   ./router_cache_file
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace transport_catalogue::store;
+using namespace std::literals;
+
+namespace {
+	namespace fs = std::filesystem;
+
+	void FillCatalogue(TransportCatalogue& catalogue) {
+		catalogue.AddStop("A"s, { 55.611087, 37.20829 });
+		catalogue.AddStop("B"s, { 55.595884, 37.209755 });
+		catalogue.AddStop("C"s, { 55.632761, 37.333324 });
+		catalogue.AddStop("D"s, { 55.574371, 37.6517 });
+		catalogue.AddStop("E"s, { 55.581065, 37.64839 });
+		catalogue.AddStop("F"s, { 55.587655, 37.645687 });
+		catalogue.AddStop("G"s, { 55.592028, 37.653656 });	// ни один автобус не проходит
+		catalogue.SetDistance("A"s, "B"s, 3900);
+		catalogue.SetDistance("B"s, "C"s, 9900);
+		catalogue.SetDistance("C"s, "B"s, 9500);
+		catalogue.SetDistance("C"s, "D"s, 7500);
+		catalogue.SetDistance("D"s, "E"s, 1800);
+		catalogue.SetDistance("E"s, "F"s, 2400);
+		catalogue.SetDistance("F"s, "D"s, 1300);
+		catalogue.SetDistance("A"s, "F"s, 12000);
+		catalogue.AddBus("256"s, { 0, 1, 2 }, false);
+		catalogue.AddBus("750"s, { 2, 3, 4, 5, 3 }, true);
+		catalogue.AddBus("828"s, { 0, 5 }, false);
+	}
+
+	// Ответы CreatRoute по всем парам остановок одной строкой, времена с полной точностью
+	std::string CollectRoutes(const std::shared_ptr<const CatalogueSnapshot>& snapshot, const route::RouteSettings& settings) {
+		const route::TransportRouter router(snapshot, settings);
+		std::ostringstream out;
+		out.precision(17);
+		for (const Stop& from : snapshot->GetStops()) {
+			for (const Stop& to : snapshot->GetStops()) {
+				out << from.name << " -> " << to.name << ':';
+				const std::optional<std::vector<route::RouteData>> route_data = router.CreatRoute(from.name, to.name);
+				if (!route_data) {
+					out << " none\n";
+					continue;
+				}
+				for (const route::RouteData& data : *route_data) {
+					out << ' ' << data.type << '/' << data.bus_name << data.stop_name << '/' << data.span_count
+						<< '/' << data.motion_time << '/' << data.bus_wait_time;
+				}
+				out << '\n';
+			}
+		}
+		return out.str();
+	}
+
+	int Check(bool condition, std::string_view message) {
+		if (!condition) {
+			std::cerr << message << '\n';
+			return 1;
+		}
+		return 0;
+	}
+
+	int CheckCacheFile(route::RouteSettings settings, const fs::path& path) {
+		TransportCatalogue catalogue;
+		FillCatalogue(catalogue);
+		std::shared_ptr<const CatalogueSnapshot> snapshot = catalogue.Freeze();
+		settings.engine = route::RouterEngine::FLOYD_WARSHALL;
+		const route::RouteSettings uncached_settings = settings;
+		settings.cache_file = path.string();
+		fs::remove(path);
+
+		int failures = 0;
+		const std::string first = CollectRoutes(snapshot, settings);
+		failures += Check(fs::exists(path), "cache file is not saved");
+		failures += Check(first == CollectRoutes(snapshot, uncached_settings), "first run differs from uncached router");
+
+		// Загрузка не трогает файл, пересчёт заменил бы его новым
+		const fs::file_time_type old_time = fs::file_time_type::clock::now() - std::chrono::hours(24);
+		fs::last_write_time(path, old_time);
+		failures += Check(first == CollectRoutes(snapshot, settings), "second run differs from first");
+		failures += Check(fs::last_write_time(path) == old_time, "matching cache file is rebuilt");
+
+		catalogue.SetDistance("A"s, "F"s, 60000);
+		snapshot = catalogue.Freeze();
+		const std::string changed = CollectRoutes(snapshot, settings);
+		failures += Check(changed != first, "changed distance does not change routes");
+		failures += Check(changed == CollectRoutes(snapshot, uncached_settings), "stale cache file is loaded");
+		failures += Check(fs::last_write_time(path) != old_time, "stale cache file is not rebuilt");
+
+		fs::remove(path);
+		return failures;
+	}
+}
+
+int main() {
+	const fs::path path = fs::temp_directory_path() / "router_cache_file_test.bin";
+	int failures = 0;
+	for (const route::GraphModel model : { route::GraphModel::COMPLETE, route::GraphModel::LINEAR }) {
+		for (const bool use_integer_weights : { false, true }) {
+			route::RouteSettings settings;
+			settings.bus_wait_time = 6;
+			settings.bus_velocity = 40;
+			settings.graph_model = model;
+			settings.use_integer_weights = use_integer_weights;
+			failures += CheckCacheFile(settings, path);
+		}
+	}
+	if (failures != 0) {
+		std::cerr << failures << " failures\n";
+		return 1;
+	}
+	std::cout << "OK\n";
+	return 0;
+}